@@ -0,0 +1,13 @@
+class CargoDist extends AIInfo {
+	function GetAuthor()      { return "OpenTTD NoAI Developers Team"; }
+	function GetName()        { return "CargoDist"; }
+	function GetShortName()   { return "REGC"; }
+	function GetDescription() { return "This runs buses between the stops in a town with cargodist and dumps the cargo waiting at the stops. On the same map the result should always be the same."; }
+	function GetVersion()     { return 1; }
+	function GetAPIVersion()  { return "13"; }
+	function GetDate()        { return "2026-10-18"; }
+	function CreateInstance() { return "CargoDist"; }
+	function UseAsRandomAI()  { return false; }
+}
+
+RegisterAI(CargoDist());
@@ -0,0 +1,195 @@
+/*
+ * Builds bus stops in the town and runs buses between them, with cargodist
+ * for passengers set in test.sav. For a while the buses are stopped, so the
+ * cargo piles up and gets truncated, and the headquarters is built next to a
+ * stop at the edge of the town and moved away again. The cargo waiting at the
+ * stops is dumped at a fixed interval, per next hop and per origin, so any
+ * change in the order the packets of a stop are loaded, merged or truncated in
+ * shows up, as does what the stops accept.
+ */
+class CargoDist extends AIController {
+	function Start();
+};
+
+function CargoDist::Check(what, result)
+{
+	if (!result) print("  " + what + " failed: " + AIError.GetLastErrorString());
+	return result;
+}
+
+function CargoDist::Around(centre, radius)
+{
+	local tiles = AITileList();
+	local x = AIMap.GetTileX(centre);
+	local y = AIMap.GetTileY(centre);
+	local max_x = AIMap.GetMapSizeX() - 2, max_y = AIMap.GetMapSizeY() - 2;
+	tiles.AddRectangle(AIMap.GetTileIndex(max(x - radius, 1), max(y - radius, 1)), AIMap.GetTileIndex(min(x + radius, max_x), min(y + radius, max_y)));
+	tiles.Valuate(AITile.GetDistanceManhattanToTile, centre);
+	tiles.Sort(AIList.SORT_BY_VALUE, AIList.SORT_ASCENDING);
+	return tiles;
+}
+
+function CargoDist::BuildStops(town, count)
+{
+	local stops = [];
+	foreach (tile, _ in this.Around(AITown.GetLocation(town), 10)) {
+		if (stops.len() == count) break;
+		if (!AIRoad.IsRoadTile(tile) || AITile.IsStationTile(tile)) continue;
+
+		local far = true;
+		foreach (stop in stops) {
+			if (AIMap.DistanceManhattan(tile, AIStation.GetLocation(stop)) < 4) far = false;
+		}
+		if (!far) continue;
+
+		/* Drive-through stops can only be built on straight roads. */
+		local dx = AIMap.GetTileIndex(1, 0), dy = AIMap.GetTileIndex(0, 1);
+		foreach (axis in [[dx, dy], [dy, dx]]) {
+			local offset = axis[0], side = axis[1];
+			if (!AIRoad.AreRoadTilesConnected(tile, tile + offset) || !AIRoad.AreRoadTilesConnected(tile, tile - offset)) continue;
+			if (AIRoad.AreRoadTilesConnected(tile, tile + side) || AIRoad.AreRoadTilesConnected(tile, tile - side)) continue;
+			if (AIRoad.BuildDriveThroughRoadStation(tile, tile + offset, AIRoad.ROADVEHTYPE_BUS, AIStation.STATION_NEW)) {
+				stops.append(AIStation.GetStationID(tile));
+				print("  stop " + AIStation.GetStationID(tile) + " at " + tile);
+			}
+			break;
+		}
+	}
+	return stops;
+}
+
+function CargoDist::BuildDepot(town)
+{
+	foreach (tile, _ in this.Around(AITown.GetLocation(town), 10)) {
+		if (!AITile.IsBuildable(tile)) continue;
+		foreach (offset in [1, -1, AIMap.GetTileIndex(0, 1), -AIMap.GetTileIndex(0, 1)]) {
+			local front = tile + offset;
+			if (!AIRoad.IsRoadTile(front) || AITile.IsStationTile(front)) continue;
+			if (!AIRoad.BuildRoadDepot(tile, front)) continue;
+			if (!AIRoad.AreRoadTilesConnected(tile, front)) this.Check("depot road", AIRoad.BuildRoad(tile, front));
+			print("  depot at " + tile);
+			return tile;
+		}
+	}
+	return null;
+}
+
+function CargoDist::BuildLoneStop(town, cargo)
+{
+	foreach (tile, _ in this.Around(AITown.GetLocation(town), 12)) {
+		if (!AITile.IsBuildable(tile) || !AITile.IsBuildable(tile + 1) || !AITile.IsBuildable(tile - 1)) continue;
+		local acceptance = AITile.GetCargoAcceptance(tile, cargo, 1, 1, 3);
+		if (acceptance < 4 || acceptance >= 8) continue;
+		if (!AIRoad.BuildDriveThroughRoadStation(tile, tile + 1, AIRoad.ROADVEHTYPE_BUS, AIStation.STATION_NEW)) continue;
+		print("  lone stop " + AIStation.GetStationID(tile) + " at " + tile + " acceptance " + acceptance);
+		return AIStation.GetStationID(tile);
+	}
+	print("  lone stop failed");
+	return null;
+}
+
+function CargoDist::BuildHQ(centre)
+{
+	foreach (tile, _ in this.Around(centre, 8)) {
+		if (!AICompany.BuildCompanyHQ(tile)) continue;
+		print("  hq at " + tile);
+		return;
+	}
+	print("  hq failed");
+}
+
+function CargoDist::Dump(title, list)
+{
+	local line = "      " + title + ":";
+	for (local i = list.Begin(); !list.IsEnd(); i = list.Next()) {
+		line += " " + i + "=" + list.GetValue(i);
+	}
+	print(line);
+}
+
+function CargoDist::Start()
+{
+	AICompany.SetLoanAmount(AICompany.GetMaxLoanAmount());
+	AIRoad.SetCurrentRoadType(AIRoad.ROADTYPE_ROAD);
+
+	local cargos = AICargoList();
+	cargos.Valuate(AICargo.HasCargoClass, AICargo.CC_PASSENGERS);
+	cargos.KeepValue(1);
+	cargos.Sort(AIList.SORT_BY_ITEM, AIList.SORT_ASCENDING);
+	local passengers = cargos.Begin();
+
+	print("");
+	print("--Build--");
+	local towns = AITownList();
+	towns.Sort(AIList.SORT_BY_ITEM, AIList.SORT_ASCENDING);
+	local town = towns.Begin();
+	local stops = this.BuildStops(town, 4);
+	local depot = this.BuildDepot(town);
+	/* A stop that accepts passengers only while the headquarters is next to it. */
+	local lone = this.BuildLoneStop(town, passengers);
+
+	local engines = AIEngineList(AIVehicle.VT_ROAD);
+	engines.Valuate(AIEngine.GetRoadType);
+	engines.KeepValue(AIRoad.ROADTYPE_ROAD);
+	engines.Valuate(AIEngine.IsBuildable);
+	engines.KeepValue(1);
+	engines.Valuate(AIEngine.GetCargoType);
+	engines.KeepValue(passengers);
+	engines.Sort(AIList.SORT_BY_ITEM, AIList.SORT_ASCENDING);
+	local engine = engines.Begin();
+	print("  engine: " + AIEngine.GetName(engine));
+
+	/* Buses visiting the stops in turn, one of them the other way round. */
+	local vehicles = [];
+	for (local i = 0; i < 4; i++) {
+		local v = AIVehicle.BuildVehicle(depot, engine);
+		if (!this.Check("bus " + i, AIVehicle.IsValidVehicle(v))) continue;
+		for (local j = 0; j < stops.len(); j++) {
+			local stop = stops[i == 3 ? stops.len() - 1 - j : (i + j) % stops.len()];
+			this.Check("order", AIOrder.AppendOrder(v, AIStation.GetLocation(stop), AIOrder.OF_NONE));
+		}
+		AIVehicle.StartStopVehicle(v);
+		vehicles.append(v);
+		this.Sleep(100);
+	}
+
+	print("");
+	print("--Cargo--");
+	local start = this.GetTick();
+	for (local n = 0; this.GetTick() - start < 24000; n++) {
+		/* Leave the stops without service for a while, so the ratings drop far
+		 * enough for the waiting cargo to be truncated. */
+		if (n == 20 || n == 40) {
+			print("  " + (n == 20 ? "stopping" : "starting") + " buses");
+			foreach (v in vehicles) this.Check("start/stop", AIVehicle.StartStopVehicle(v));
+			/* Moving the headquarters changes what the stops around it accept. */
+			this.BuildHQ(n == 20 ? AIStation.GetLocation(lone) : AIMap.GetTileIndex(58, 58));
+		}
+
+		local line = "  " + (this.GetTick() - start) + ":";
+		foreach (stop in stops) {
+			line += " " + AIStation.GetCargoWaiting(stop, passengers) + "/" + AIStation.GetCargoPlanned(stop, passengers) + "/" + AIStation.GetCargoRating(stop, passengers);
+		}
+		print(line);
+
+		if (n % 6 == 5) {
+			foreach (stop in stops) {
+				print("    " + stop);
+				this.Dump("waiting by via", AIStationList_CargoWaitingByVia(stop, passengers));
+				this.Dump("waiting by from", AIStationList_CargoWaitingByFrom(stop, passengers));
+				this.Dump("planned by via", AIStationList_CargoPlannedByVia(stop, passengers));
+				this.Dump("planned by from", AIStationList_CargoPlannedByFrom(stop, passengers));
+				this.Dump("accepting", AICargoList_StationAccepting(stop));
+			}
+			print("    " + lone);
+			this.Dump("accepting", AICargoList_StationAccepting(lone));
+		}
+		this.Sleep(370);
+	}
+
+	print("");
+	print("--Vehicles--");
+	foreach (v in vehicles) {
+		print("  " + v + ": " + AIVehicle.GetLocation(v) + " load " + AIVehicle.GetCargoLoad(v, passengers) + " profit " + AIVehicle.GetProfitThisYear(v));
+	}
+}
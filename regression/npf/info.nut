@@ -0,0 +1,13 @@
+class NPF extends AIInfo {
+	function GetAuthor()      { return "OpenTTD NoAI Developers Team"; }
+	function GetName()        { return "NPF"; }
+	function GetShortName()   { return "REGN"; }
+	function GetDescription() { return "This runs trains, road vehicles and ships with NPF over a network with several routes. On the same map the result should always be the same."; }
+	function GetVersion()     { return 1; }
+	function GetAPIVersion()  { return "13"; }
+	function GetDate()        { return "2026-10-18"; }
+	function CreateInstance() { return "Pathfinder"; }
+	function UseAsRandomAI()  { return false; }
+}
+
+RegisterAI(NPF());
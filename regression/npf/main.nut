@@ -0,0 +1,232 @@
+/*
+ * Builds a rail loop with a shortcut, a road grid and a canal ring with an
+ * island, and puts vehicles on them. The vehicle positions are dumped at a
+ * fixed interval, so any change in the routes the pathfinders choose, in the
+ * way they reserve paths or in the depots they find shows up.
+ * The pathfinders in use are set in test.sav.
+ */
+class Pathfinder extends AIController {
+	function Start();
+};
+
+function Pathfinder::Tile(x, y)
+{
+	return AIMap.GetTileIndex(x, y);
+}
+
+function Pathfinder::Check(what, result)
+{
+	if (!result) print("  " + what + " failed: " + AIError.GetLastErrorString());
+	return result;
+}
+
+function Pathfinder::PickEngine(list, cargo)
+{
+	list.Valuate(AIEngine.IsBuildable);
+	list.KeepValue(1);
+	list.Valuate(AIEngine.GetCargoType);
+	list.KeepValue(cargo);
+	list.Sort(AIList.SORT_BY_ITEM, AIList.SORT_ASCENDING);
+	return list.Begin();
+}
+
+function Pathfinder::BuildRail()
+{
+	print("");
+	print("--Rail--");
+
+	local types = AIRailTypeList();
+	AIRail.SetCurrentRailType(types.Begin());
+
+	/* Station A on the top side, station B on the bottom side. */
+	this.Check("station A", AIRail.BuildRailStation(Tile(15, 6), AIRail.RAILTRACK_NE_SW, 1, 4, AIStation.STATION_NEW));
+	this.Check("station B", AIRail.BuildRailStation(Tile(10, 14), AIRail.RAILTRACK_NE_SW, 1, 4, AIStation.STATION_NEW));
+
+	/* The loop; trains run +x on the top, +y on the right, -x on the bottom and -y on the left. */
+	for (local x = 6; x < 40; x++) {
+		if (x < 15 || x > 18) this.Check("top " + x, AIRail.BuildRailTrack(Tile(x, 6), AIRail.RAILTRACK_NE_SW));
+		if (x < 10 || x > 13) this.Check("bottom " + x, AIRail.BuildRailTrack(Tile(x, 14), AIRail.RAILTRACK_NE_SW));
+	}
+	for (local y = 7; y < 14; y++) {
+		this.Check("left " + y, AIRail.BuildRailTrack(Tile(5, y), AIRail.RAILTRACK_NW_SE));
+		this.Check("right " + y, AIRail.BuildRailTrack(Tile(40, y), AIRail.RAILTRACK_NW_SE));
+	}
+	this.Check("corner N", AIRail.BuildRailTrack(Tile(5, 6), AIRail.RAILTRACK_SW_SE));
+	this.Check("corner E", AIRail.BuildRailTrack(Tile(40, 6), AIRail.RAILTRACK_NE_SE));
+	this.Check("corner S", AIRail.BuildRailTrack(Tile(40, 14), AIRail.RAILTRACK_NW_NE));
+	this.Check("corner W", AIRail.BuildRailTrack(Tile(5, 14), AIRail.RAILTRACK_NW_SW));
+
+	/* A shortcut from the top to the bottom side, which is the shorter way from A to B. */
+	this.Check("shortcut top", AIRail.BuildRailTrack(Tile(30, 6), AIRail.RAILTRACK_NE_SE));
+	for (local y = 7; y < 14; y++) {
+		this.Check("shortcut " + y, AIRail.BuildRailTrack(Tile(30, y), AIRail.RAILTRACK_NW_SE));
+	}
+	this.Check("shortcut bottom", AIRail.BuildRailTrack(Tile(30, 14), AIRail.RAILTRACK_NW_NE));
+
+	/* A depot next to the left and one next to the right side. */
+	this.Check("depot W", AIRail.BuildRailDepot(Tile(4, 10), Tile(5, 10)));
+	this.Check("depot W exit", AIRail.BuildRailTrack(Tile(5, 10), AIRail.RAILTRACK_NW_NE));
+	this.Check("depot W entry", AIRail.BuildRailTrack(Tile(5, 10), AIRail.RAILTRACK_NE_SE));
+	this.Check("depot E", AIRail.BuildRailDepot(Tile(41, 11), Tile(40, 11)));
+	this.Check("depot E exit", AIRail.BuildRailTrack(Tile(40, 11), AIRail.RAILTRACK_SW_SE));
+	this.Check("depot E entry", AIRail.BuildRailTrack(Tile(40, 11), AIRail.RAILTRACK_NW_SW));
+
+	/* One-way signals along the direction the trains run in; path signals in
+	 * front of the stations and junctions. The tile in front of a signal is
+	 * the tile the trains come from. */
+	local signals = [
+		[ 8,  6,  1,  0, AIRail.SIGNALTYPE_NORMAL],
+		[14,  6,  1,  0, AIRail.SIGNALTYPE_PBS_ONEWAY],
+		[22,  6,  1,  0, AIRail.SIGNALTYPE_NORMAL],
+		[28,  6,  1,  0, AIRail.SIGNALTYPE_PBS_ONEWAY],
+		[35,  6,  1,  0, AIRail.SIGNALTYPE_NORMAL],
+		[40, 10,  0,  1, AIRail.SIGNALTYPE_NORMAL],
+		[33, 14, -1,  0, AIRail.SIGNALTYPE_NORMAL],
+		[30,  9,  0,  1, AIRail.SIGNALTYPE_NORMAL],
+		[30, 12,  0,  1, AIRail.SIGNALTYPE_NORMAL],
+		[27, 14, -1,  0, AIRail.SIGNALTYPE_NORMAL],
+		[20, 14, -1,  0, AIRail.SIGNALTYPE_NORMAL],
+		[14, 14, -1,  0, AIRail.SIGNALTYPE_PBS_ONEWAY],
+		[ 7, 14, -1,  0, AIRail.SIGNALTYPE_NORMAL],
+		[ 5, 12,  0, -1, AIRail.SIGNALTYPE_PBS_ONEWAY],
+		[ 5,  8,  0, -1, AIRail.SIGNALTYPE_NORMAL],
+	];
+	foreach (s in signals) {
+		this.Check("signal " + s[0] + "," + s[1], AIRail.BuildSignal(Tile(s[0], s[1]), Tile(s[0] - s[2], s[1] - s[3]), s[4]));
+	}
+
+	local engines = AIEngineList(AIVehicle.VT_RAIL);
+	engines.Valuate(AIEngine.IsWagon);
+	engines.KeepValue(0);
+	engines.Valuate(AIEngine.HasPowerOnRail, AIRail.GetCurrentRailType());
+	engines.KeepValue(1);
+	engines.Valuate(AIEngine.IsBuildable);
+	engines.KeepValue(1);
+	engines.Sort(AIList.SORT_BY_ITEM, AIList.SORT_ASCENDING);
+	local engine = engines.Begin();
+	print("  engine: " + AIEngine.GetName(engine));
+
+	local vehicles = [];
+	for (local i = 0; i < 3; i++) {
+		local v = AIVehicle.BuildVehicle(Tile(4, 10), engine);
+		if (!this.Check("train " + i, AIVehicle.IsValidVehicle(v))) continue;
+		this.Check("order A", AIOrder.AppendOrder(v, Tile(15, 6), AIOrder.OF_NONE));
+		if (i < 2) this.Check("order depot", AIOrder.AppendOrder(v, Tile(4, 10), AIOrder.OF_GOTO_NEAREST_DEPOT));
+		this.Check("order B", AIOrder.AppendOrder(v, Tile(10, 14), AIOrder.OF_NONE));
+		vehicles.append(v);
+	}
+	return vehicles;
+}
+
+function Pathfinder::BuildRoad(passengers)
+{
+	print("");
+	print("--Road--");
+
+	AIRoad.SetCurrentRoadType(AIRoad.ROADTYPE_ROAD);
+
+	/* A grid of three rows and three columns, so there are several routes of the same length. */
+	foreach (y in [20, 25, 30]) this.Check("row " + y, AIRoad.BuildRoad(Tile(5, y), Tile(40, y)));
+	foreach (x in [5, 22, 40]) this.Check("column " + x, AIRoad.BuildRoad(Tile(x, 20), Tile(x, 30)));
+
+	this.Check("stop A", AIRoad.BuildDriveThroughRoadStation(Tile(10, 20), Tile(11, 20), AIRoad.ROADVEHTYPE_BUS, AIStation.STATION_NEW));
+	this.Check("stop B", AIRoad.BuildDriveThroughRoadStation(Tile(35, 30), Tile(36, 30), AIRoad.ROADVEHTYPE_BUS, AIStation.STATION_NEW));
+	this.Check("depot N", AIRoad.BuildRoadDepot(Tile(13, 19), Tile(13, 20)));
+	this.Check("depot N road", AIRoad.BuildRoad(Tile(13, 19), Tile(13, 20)));
+	this.Check("depot S", AIRoad.BuildRoadDepot(Tile(38, 31), Tile(38, 30)));
+	this.Check("depot S road", AIRoad.BuildRoad(Tile(38, 31), Tile(38, 30)));
+
+	local engines = AIEngineList(AIVehicle.VT_ROAD);
+	engines.Valuate(AIEngine.GetRoadType);
+	engines.KeepValue(AIRoad.ROADTYPE_ROAD);
+	local engine = this.PickEngine(engines, passengers);
+	print("  engine: " + AIEngine.GetName(engine));
+
+	local vehicles = [];
+	for (local i = 0; i < 3; i++) {
+		local v = AIVehicle.BuildVehicle(Tile(13, 19), engine);
+		if (!this.Check("bus " + i, AIVehicle.IsValidVehicle(v))) continue;
+		this.Check("order A", AIOrder.AppendOrder(v, Tile(10, 20), AIOrder.OF_NONE));
+		if (i == 0) this.Check("order depot", AIOrder.AppendOrder(v, Tile(13, 19), AIOrder.OF_GOTO_NEAREST_DEPOT));
+		this.Check("order B", AIOrder.AppendOrder(v, Tile(35, 30), AIOrder.OF_NONE));
+		if (i != 0) this.Check("order depot", AIOrder.AppendOrder(v, Tile(13, 19), AIOrder.OF_GOTO_NEAREST_DEPOT));
+		vehicles.append(v);
+	}
+	return vehicles;
+}
+
+function Pathfinder::BuildWater(passengers)
+{
+	print("");
+	print("--Water--");
+
+	/* A ring of canals with a channel through the middle of the island. */
+	for (local x = 45; x <= 56; x++) {
+		this.Check("canal " + x + ",20", AIMarine.BuildCanal(Tile(x, 20)));
+		this.Check("canal " + x + ",30", AIMarine.BuildCanal(Tile(x, 30)));
+	}
+	for (local y = 21; y < 30; y++) {
+		foreach (x in [45, 50, 56]) this.Check("canal " + x + "," + y, AIMarine.BuildCanal(Tile(x, y)));
+	}
+	foreach (x in [47, 52]) {
+		this.Check("canal depot " + x, AIMarine.BuildCanal(Tile(x, 31)));
+		this.Check("canal depot " + x, AIMarine.BuildCanal(Tile(x, 32)));
+		this.Check("depot " + x, AIMarine.BuildWaterDepot(Tile(x, 31), Tile(x, 30)));
+	}
+	this.Check("buoy A", AIMarine.BuildBuoy(Tile(47, 20)));
+	this.Check("buoy B", AIMarine.BuildBuoy(Tile(54, 30)));
+	this.Check("buoy C", AIMarine.BuildBuoy(Tile(45, 27)));
+
+	local engine = this.PickEngine(AIEngineList(AIVehicle.VT_WATER), passengers);
+	print("  engine: " + AIEngine.GetName(engine));
+
+	local vehicles = [];
+	for (local i = 0; i < 2; i++) {
+		local v = AIVehicle.BuildVehicle(Tile(52, 31), engine);
+		if (!this.Check("ship " + i, AIVehicle.IsValidVehicle(v))) continue;
+		this.Check("order A", AIOrder.AppendOrder(v, Tile(47, 20), AIOrder.OF_NONE));
+		if (i == 1) this.Check("order depot", AIOrder.AppendOrder(v, Tile(52, 31), AIOrder.OF_GOTO_NEAREST_DEPOT));
+		this.Check("order B", AIOrder.AppendOrder(v, Tile(54, 30), AIOrder.OF_NONE));
+		if (i == 0) this.Check("order depot", AIOrder.AppendOrder(v, Tile(52, 31), AIOrder.OF_GOTO_NEAREST_DEPOT));
+		if (i == 1) this.Check("order C", AIOrder.AppendOrder(v, Tile(45, 27), AIOrder.OF_NONE));
+		vehicles.append(v);
+	}
+	return vehicles;
+}
+
+function Pathfinder::Start()
+{
+	AICompany.SetLoanAmount(AICompany.GetMaxLoanAmount());
+
+	local cargos = AICargoList();
+	cargos.Valuate(AICargo.HasCargoClass, AICargo.CC_PASSENGERS);
+	cargos.KeepValue(1);
+	cargos.Sort(AIList.SORT_BY_ITEM, AIList.SORT_ASCENDING);
+	local passengers = cargos.Begin();
+
+	local vehicles = [];
+	vehicles.extend(this.BuildRail());
+	vehicles.extend(this.BuildRoad(passengers));
+	vehicles.extend(this.BuildWater(passengers));
+
+	print("");
+	print("--Routes--");
+	foreach (v in vehicles) {
+		AIVehicle.StartStopVehicle(v);
+		this.Sleep(40);
+	}
+
+	local start = this.GetTick();
+	while (this.GetTick() - start < 20000) {
+		local line = "  " + (this.GetTick() - start) + ":";
+		foreach (v in vehicles) line += " " + AIVehicle.GetLocation(v);
+		print(line);
+		this.Sleep(50);
+	}
+
+	print("");
+	print("--Vehicles--");
+	foreach (v in vehicles) {
+		print("  " + v + ": " + AIVehicle.GetLocation(v) + " age " + AIVehicle.GetAge(v) + " profit " + AIVehicle.GetProfitThisYear(v) + " reliability " + AIVehicle.GetReliability(v));
+	}
+}
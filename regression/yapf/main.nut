@@ -0,0 +1 @@
+require("../npf/main.nut");
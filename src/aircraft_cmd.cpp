@@ -1377,6 +1377,7 @@ static void MaybeCrashAirplane(Aircraft *v)
 		st->goods[i].rating = 1;
 		st->goods[i].cargo.Truncate();
 	}
+	st->rating_cargoes = ALL_CARGOTYPES;
 
 	CrashAirplane(v);
 }
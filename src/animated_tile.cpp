@@ -10,25 +10,61 @@
 #include "stdafx.h"
 #include "core/alloc_func.hpp"
 #include "core/smallvec_type.hpp"
+#include "map_func.h"
 #include "tile_cmd.h"
 #include "viewport_func.h"
 #include "framerate_type.h"
 
 #include "safeguards.h"
 
-/** The table/list with animated tiles. */
+/** The table/list with animated tiles. Deleted tiles leave an #INVALID_TILE entry until the next AnimateAnimatedTiles. */
 std::vector<TileIndex> _animated_tiles;
+/** Per tile: the position of its entry in #_animated_tiles, or #INVALID_ANIMATED_TILE_INDEX when the tile is not animated. */
+static std::vector<uint32> _animated_tile_index;
+/** Index of a tile that has no entry in #_animated_tiles. */
+static const uint32 INVALID_ANIMATED_TILE_INDEX = UINT32_MAX;
+
+/**
+ * Rebuild the per tile index of the animated tile table, e.g. after it has
+ * been loaded from a savegame. Duplicate and deleted entries are removed from the table.
+ */
+void RebuildAnimatedTileIndex()
+{
+	_animated_tile_index.assign(MapSize(), INVALID_ANIMATED_TILE_INDEX);
+
+	size_t kept = 0;
+	for (size_t i = 0; i < _animated_tiles.size(); i++) {
+		const TileIndex tile = _animated_tiles[i];
+		if (tile >= MapSize() || _animated_tile_index[tile] != INVALID_ANIMATED_TILE_INDEX) continue;
+		_animated_tile_index[tile] = (uint32)kept;
+		_animated_tiles[kept++] = tile;
+	}
+	_animated_tiles.resize(kept);
+}
+
+/**
+ * Make sure the index covers the whole map; the map might have been
+ * reallocated since the index was built.
+ */
+static inline void ValidateAnimatedTileIndex()
+{
+	if (_animated_tile_index.size() != MapSize()) RebuildAnimatedTileIndex();
+}
 
 /**
  * Removes the given tile from the animated tile table.
+ * Its entry is replaced by #INVALID_TILE, so the other tiles keep their place;
+ * it gets removed from the table during the next AnimateAnimatedTiles.
  * @param tile the tile to remove
  */
 void DeleteAnimatedTile(TileIndex tile)
 {
-	auto to_remove = std::find(_animated_tiles.begin(), _animated_tiles.end(), tile);
-	if (to_remove != _animated_tiles.end()) {
-		/* The order of the remaining elements must stay the same, otherwise the animation loop may miss a tile. */
-		_animated_tiles.erase(to_remove);
+	ValidateAnimatedTileIndex();
+
+	uint32 &index = _animated_tile_index[tile];
+	if (index != INVALID_ANIMATED_TILE_INDEX) {
+		_animated_tiles[index] = INVALID_TILE;
+		index = INVALID_ANIMATED_TILE_INDEX;
 		MarkTileDirtyByTile(tile);
 	}
 }
@@ -40,32 +76,42 @@ void DeleteAnimatedTile(TileIndex tile)
  */
 void AddAnimatedTile(TileIndex tile)
 {
+	ValidateAnimatedTileIndex();
+
 	MarkTileDirtyByTile(tile);
-	include(_animated_tiles, tile);
+	if (_animated_tile_index[tile] != INVALID_ANIMATED_TILE_INDEX) return;
+
+	_animated_tile_index[tile] = (uint32)_animated_tiles.size();
+	_animated_tiles.push_back(tile);
 }
 
 /**
  * Animate all tiles in the animated tile list, i.e.\ call AnimateTile on them.
+ * Entries of deleted tiles are removed along the way.
  */
 void AnimateAnimatedTiles()
 {
 	PerformanceAccumulator framerate(PFE_GL_LANDSCAPE);
 
-	const TileIndex *ti = _animated_tiles.data();
-	while (ti < _animated_tiles.data() + _animated_tiles.size()) {
-		const TileIndex curr = *ti;
+	ValidateAnimatedTileIndex();
+
+	/* AnimateTile may add tiles to the end of the table, so it cannot be
+	 * iterated by pointer; tiles that are added are animated this tick too.
+	 * Tiles deleted during the loop merely leave an invalid entry, so the
+	 * slots of the remaining tiles do not move while we are iterating. */
+	size_t kept = 0;
+	for (size_t i = 0; i < _animated_tiles.size(); i++) {
+		const TileIndex curr = _animated_tiles[i];
+		if (curr == INVALID_TILE) continue;
+
 		AnimateTile(curr);
-		/* During the AnimateTile call, DeleteAnimatedTile could have been called,
-		 * deleting an element we've already processed and pushing the rest one
-		 * slot to the left. We can detect this by checking whether the index
-		 * in the current slot has changed - if it has, an element has been deleted,
-		 * and we should process the current slot again instead of going forward.
-		 * NOTE: this will still break if more than one animated tile is being
-		 *       deleted during the same AnimateTile call, but no code seems to
-		 *       be doing this anyway.
-		 */
-		if (*ti == curr) ++ti;
+		/* The tile might have deleted itself. */
+		if (_animated_tiles[i] != curr) continue;
+
+		_animated_tile_index[curr] = (uint32)kept;
+		_animated_tiles[kept++] = curr;
 	}
+	_animated_tiles.resize(kept);
 }
 
 /**
@@ -74,4 +120,5 @@ void AnimateAnimatedTiles()
 void InitializeAnimatedTiles()
 {
 	_animated_tiles.clear();
+	RebuildAnimatedTileIndex();
 }
@@ -16,5 +16,6 @@ void AddAnimatedTile(TileIndex tile);
 void DeleteAnimatedTile(TileIndex tile);
 void AnimateAnimatedTiles();
 void InitializeAnimatedTiles();
+void RebuildAnimatedTileIndex();
 
 #endif /* ANIMATED_TILE_FUNC_H */
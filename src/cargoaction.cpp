@@ -203,10 +203,11 @@ bool StationCargoReroute::operator()(CargoPacket *cp)
 		this->destination->AddToCache(cp_new);
 	}
 
-	/* Legal, as insert doesn't invalidate iterators in the MultiMap, however
-	 * this might insert the packet between range.first and range.second (which might be end())
+	/* Legal, as inserting with another key doesn't invalidate iterators into the range being
+	 * shifted in the MultiMap, however this might insert the packet between range.first and
+	 * range.second (which might be end())
 	 * This is why we check for GetKey above to avoid infinite loops. */
-	this->destination->packets.Insert(next, cp_new);
+	this->destination->Insert(cp_new, next);
 	return cp_new == cp;
 }
 
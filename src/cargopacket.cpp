@@ -9,6 +9,8 @@
 
 #include "stdafx.h"
 #include "station_base.h"
+#include "vehicle_base.h"
+#include "debug.h"
 #include "core/pool_func.hpp"
 #include "core/random_func.hpp"
 #include "economy_base.h"
@@ -21,6 +23,10 @@
 CargoPacketPool _cargopacket_pool("CargoPacket");
 INSTANTIATE_POOL_METHODS(CargoPacket)
 
+/* static */ uint32 StationCargoList::merge_generation = 0;
+
+static size_t _last_compacted_packets = 0; ///< Number of packets freed by the last compaction.
+
 /**
  * Create a new packet for savegame loading.
  */
@@ -129,6 +135,7 @@ void CargoPacket::Reduce(uint count)
 	for (CargoPacket *cp : CargoPacket::Iterate()) {
 		if (cp->source_type == src_type && cp->source_id == src) cp->source_id = INVALID_SOURCE;
 	}
+	StationCargoList::InvalidateMergeIndices();
 }
 
 /**
@@ -142,6 +149,43 @@ void CargoPacket::Reduce(uint count)
 	}
 }
 
+/**
+ * Merge the mergeable packets in all station and vehicle cargo lists, so long
+ * running games don't fill the pool with small packets. This changes the order
+ * of the packets, so it has to run at the same moment for all clients.
+ */
+void CompactCargoPackets()
+{
+	size_t freed = 0;
+	for (Station *st : Station::Iterate()) {
+		for (CargoID c = 0; c < NUM_CARGO; c++) freed += st->goods[c].cargo.Compact();
+	}
+	for (Vehicle *v : Vehicle::Iterate()) freed += v->cargo.Compact();
+
+	_last_compacted_packets = freed;
+	Debug(misc, 1, "Compacted cargo packets: {} freed, {} left", freed, CargoPacket::GetNumItems());
+}
+
+/**
+ * Get the statistics about the cargo packets.
+ * @return The statistics.
+ */
+CargoPacketStatistics GetCargoPacketStatistics()
+{
+	CargoPacketStatistics stats;
+	stats.packets = CargoPacket::GetNumItems();
+	stats.station_packets = 0;
+	for (const Station *st : Station::Iterate()) {
+		for (CargoID c = 0; c < NUM_CARGO; c++) stats.station_packets += st->goods[c].cargo.Packets()->size();
+	}
+	stats.vehicle_packets = 0;
+	for (const Vehicle *v : Vehicle::Iterate()) stats.vehicle_packets += v->cargo.Packets()->size();
+	stats.pool_size = _cargopacket_pool.size;
+	stats.memory = stats.packets * sizeof(CargoPacket) + stats.pool_size * sizeof(CargoPacket *);
+	stats.last_compacted = _last_compacted_packets;
+	return stats;
+}
+
 /*
  *
  * Cargo list implementation
@@ -390,6 +434,34 @@ void VehicleCargoList::AgeCargo()
 	}
 }
 
+/**
+ * Merges each packet into the first packet before it that it can be merged
+ * with, so fragmented cargo needs fewer packets. When that packet is full,
+ * the following packets of its kind are merged into the one that did not
+ * fit anymore. This is only done while no cargo is designated for loading
+ * or unloading, as the designations depend on the order of the packets.
+ * @return Number of packets freed.
+ */
+uint VehicleCargoList::Compact()
+{
+	if (this->action_counts[MTA_KEEP] != this->count || this->packets.size() < 2) return 0;
+
+	uint freed = 0;
+	std::unordered_map<MergeKey, CargoPacket *, MergeKeyHash> first;
+	for (Iterator it(this->packets.begin()); it != this->packets.end();) {
+		CargoPacket *&icp = first[MergeKey(*it)];
+		if (icp != nullptr && VehicleCargoList::TryMerge(icp, *it)) {
+			it = this->packets.erase(it);
+			freed++;
+			continue;
+		}
+		/* Either the first of its kind, or the previous one is full. */
+		icp = *it;
+		++it;
+	}
+	return freed;
+}
+
 /**
  * Sets loaded_at_xy to the current station for all cargo to be transferred.
  * This is done when stopping or skipping while the vehicle is unloading. In
@@ -692,16 +764,94 @@ void StationCargoList::Append(CargoPacket *cp, StationID next)
 	assert(cp != nullptr);
 	this->AddToCache(cp);
 
+	CargoPacket *&last = this->GetMergeIndex()->last[MergeKey(cp, next)];
 	StationCargoPacketMap::List &list = this->packets[next];
-	for (StationCargoPacketMap::List::reverse_iterator it(list.rbegin());
-			it != list.rend(); it++) {
-		if (StationCargoList::TryMerge(*it, cp)) return;
+	if (last != nullptr) {
+		if (StationCargoList::TryMerge(last, cp)) return;
+
+		/* The last mergeable packet is full, try the ones before it. */
+		for (StationCargoPacketMap::List::reverse_iterator it(list.rbegin());
+				it != list.rend(); it++) {
+			if (StationCargoList::TryMerge(*it, cp)) return;
+		}
 	}
 
 	/* The packet could not be merged with another one */
 	list.push_back(cp);
+	last = cp;
+}
+
+/**
+ * Appends the given cargo packet to the range of packets with the same next
+ * station, without merging it with other packets.
+ * @param cp The cargo packet to add.
+ * @param next The next hop.
+ * @pre cp != nullptr
+ */
+void StationCargoList::Insert(CargoPacket *cp, StationID next)
+{
+	assert(cp != nullptr);
+	this->packets.Insert(next, cp);
+	if (this->merge_index != nullptr && this->merge_index->generation == StationCargoList::merge_generation) {
+		this->merge_index->last[MergeKey(cp, next)] = cp;
+	}
 }
 
+/**
+ * Get the merge index of this list, rebuilding it if it is missing or outdated.
+ * @return The merge index.
+ */
+StationCargoList::MergeIndex *StationCargoList::GetMergeIndex()
+{
+	if (this->merge_index == nullptr) {
+		this->merge_index.reset(new MergeIndex());
+	} else if (this->merge_index->generation == StationCargoList::merge_generation) {
+		return this->merge_index.get();
+	}
+
+	this->merge_index->generation = StationCargoList::merge_generation;
+	this->merge_index->last.clear();
+	for (Iterator it(this->packets.begin()); it != this->packets.end(); ++it) {
+		this->merge_index->last[MergeKey(*it, it.GetKey())] = *it;
+	}
+	return this->merge_index.get();
+}
+
+/**
+ * Update the merge index for the removal of a packet from the front of its range.
+ * @param key Merge key of the packet, taken before the packet was moved.
+ * @param cp The packet; it may already be freed.
+ */
+void StationCargoList::RemoveFromMergeIndex(const MergeKey &key, const CargoPacket *cp)
+{
+	if (this->merge_index == nullptr || this->merge_index->generation != StationCargoList::merge_generation) return;
+
+	/* No other packet of the same kind is before the first one, so there is none left if it was the last one. */
+	auto it = this->merge_index->last.find(key);
+	if (it != this->merge_index->last.end() && it->second == cp) this->merge_index->last.erase(it);
+}
+
+#ifdef WITH_ASSERT
+/**
+ * Check that the merge index, if it is up to date, holds the last packet of
+ * each kind of mergeable packets of each next hop, and nothing else.
+ */
+void StationCargoList::DebugCheckMergeIndex() const
+{
+	if (this->merge_index == nullptr || this->merge_index->generation != StationCargoList::merge_generation) return;
+
+	std::unordered_map<MergeKey, const CargoPacket *, MergeKeyHash> last;
+	for (ConstIterator it(this->packets.begin()); it != this->packets.end(); ++it) {
+		last[MergeKey(*it, it.GetKey())] = *it;
+	}
+
+	assert(last.size() == this->merge_index->last.size());
+	for (const auto &entry : last) {
+		assert(this->merge_index->last.count(entry.first) != 0 && this->merge_index->last.at(entry.first) == entry.second);
+	}
+}
+#endif /* WITH_ASSERT */
+
 /**
  * Shifts cargo from the front of the packet list for a specific station and
  * applies some action to it.
@@ -721,7 +871,10 @@ bool StationCargoList::ShiftCargo(Taction &action, StationID next)
 	for (Iterator it(range.first); it != range.second && it.GetKey() == next;) {
 		if (action.MaxMove() == 0) return false;
 		CargoPacket *cp = *it;
+		/* The action may free the packet, so get its key first. */
+		MergeKey key(cp, next);
 		if (action(cp)) {
+			this->RemoveFromMergeIndex(key, cp);
 			it = this->packets.erase(it);
 		} else {
 			return false;
@@ -755,6 +908,9 @@ uint StationCargoList::ShiftCargo(Taction action, StationIDStack next, bool incl
 	if (include_invalid && action.MaxMove() > 0) {
 		this->ShiftCargo(action, INVALID_STATION);
 	}
+#ifdef WITH_ASSERT
+	this->DebugCheckMergeIndex();
+#endif
 	return max_move - action.MaxMove();
 }
 
@@ -768,43 +924,59 @@ uint StationCargoList::ShiftCargo(Taction action, StationIDStack next, bool incl
  */
 uint StationCargoList::Truncate(uint max_move, StationCargoAmountMap *cargo_per_source)
 {
+#ifdef WITH_ASSERT
+	this->DebugCheckMergeIndex();
+#endif
 	max_move = std::min(max_move, this->count);
 	uint prev_count = this->count;
 	uint moved = 0;
 	uint loop = 0;
 	bool do_count = cargo_per_source != nullptr;
+	/* Packets are removed from the middle of the ranges, so the index of packets to merge with has to be rebuilt. */
+	if (max_move > 0) this->merge_index.reset();
 	while (max_move > moved) {
-		for (Iterator it(this->packets.begin()); it != this->packets.end();) {
-			CargoPacket *cp = *it;
-			if (prev_count > max_move && RandomRange(prev_count) < prev_count - max_move) {
-				if (do_count && loop == 0) {
-					(*cargo_per_source)[cp->source] += cp->count;
+		for (StationCargoPacketMap::MapIterator map_it(this->packets.begin()); map_it != this->packets.end();) {
+			/* Move the packets that are kept to the front, so removing a packet doesn't move all packets after it. */
+			StationCargoPacketMap::List &list = map_it->second;
+			StationCargoPacketMap::ListIterator kept = list.begin();
+			for (StationCargoPacketMap::ListIterator it = list.begin(); it != list.end(); ++it) {
+				CargoPacket *cp = *it;
+				if (prev_count > max_move && RandomRange(prev_count) < prev_count - max_move) {
+					if (do_count && loop == 0) {
+						(*cargo_per_source)[cp->source] += cp->count;
+					}
+					*kept++ = cp;
+					continue;
 				}
-				++it;
-				continue;
-			}
-			uint diff = max_move - moved;
-			if (cp->count > diff) {
-				if (diff > 0) {
-					this->RemoveFromCache(cp, diff);
-					cp->Reduce(diff);
-					moved += diff;
-				}
-				if (loop > 0) {
-					if (do_count) (*cargo_per_source)[cp->source] -= diff;
-					return moved;
+				uint diff = max_move - moved;
+				if (cp->count > diff) {
+					if (diff > 0) {
+						this->RemoveFromCache(cp, diff);
+						cp->Reduce(diff);
+						moved += diff;
+					}
+					if (loop > 0) {
+						if (do_count) (*cargo_per_source)[cp->source] -= diff;
+						list.erase(kept, it);
+						return moved;
+					} else {
+						if (do_count) (*cargo_per_source)[cp->source] += cp->count;
+						*kept++ = cp;
+					}
 				} else {
-					if (do_count) (*cargo_per_source)[cp->source] += cp->count;
-					++it;
+					if (do_count && loop > 0) {
+						(*cargo_per_source)[cp->source] -= cp->count;
+					}
+					moved += cp->count;
+					this->RemoveFromCache(cp, cp->count);
+					delete cp;
 				}
+			}
+			list.erase(kept, list.end());
+			if (list.empty()) {
+				this->packets.StationCargoPacketMap::Map::erase(map_it++);
 			} else {
-				it = this->packets.erase(it);
-				if (do_count && loop > 0) {
-					(*cargo_per_source)[cp->source] -= cp->count;
-				}
-				moved += cp->count;
-				this->RemoveFromCache(cp, cp->count);
-				delete cp;
+				++map_it;
 			}
 		}
 		loop++;
@@ -812,6 +984,36 @@ uint StationCargoList::Truncate(uint max_move, StationCargoAmountMap *cargo_per_
 	return moved;
 }
 
+/**
+ * Merges each packet into the first packet with the same next hop before it
+ * that it can be merged with, so fragmented cargo needs fewer packets.
+ * @return Number of packets freed.
+ */
+uint StationCargoList::Compact()
+{
+	uint freed = 0;
+	std::unordered_map<MergeKey, CargoPacket *, MergeKeyHash> first;
+	for (auto &range : this->packets) {
+		if (range.second.size() < 2) continue;
+
+		first.clear();
+		StationCargoPacketMap::ListIterator kept = range.second.begin();
+		for (StationCargoPacketMap::ListIterator it = range.second.begin(); it != range.second.end(); ++it) {
+			CargoPacket *&icp = first[MergeKey(*it, range.first)];
+			if (icp != nullptr && StationCargoList::TryMerge(icp, *it)) {
+				freed++;
+				continue;
+			}
+			/* Either the first of its kind, or the previous one is full. */
+			icp = *it;
+			*kept++ = *it;
+		}
+		range.second.erase(kept, range.second.end());
+	}
+	if (freed > 0) this->merge_index.reset();
+	return freed;
+}
+
 /**
  * Reserves cargo for loading onto the vehicle.
  * @param max_move Maximum amount of cargo to reserve.
@@ -19,13 +19,15 @@
 #include "core/multimap.hpp"
 #include "saveload/saveload.h"
 #include <list>
+#include <memory>
+#include <unordered_map>
 
 /** Unique identifier for a single cargo packet. */
 typedef uint32 CargoPacketID;
 struct CargoPacket;
 
-/** Type of the pool for cargo packets for a little over 16 million packets. */
-typedef Pool<CargoPacket, CargoPacketID, 1024, 0xFFF000, PT_NORMAL, true, false> CargoPacketPool;
+/** Type of the pool for cargo packets for a little under 4 billion packets. */
+typedef Pool<CargoPacket, CargoPacketID, 1024, 0xFFFFF000, PT_NORMAL, true, false> CargoPacketPool;
 /** The actual pool with cargo packets. */
 extern CargoPacketPool _cargopacket_pool;
 
@@ -271,6 +273,35 @@ protected:
 	/** The (direct) parent of this class. */
 	typedef CargoList<VehicleCargoList, CargoPacketList> Parent;
 
+	/** Properties of a packet that decide which packets it can be merged with, see AreMergable(). */
+	struct MergeKey {
+		TileIndex source_xy;     ///< Origin of the packet.
+		TileIndex loaded_at_xy;  ///< Where the packet was loaded.
+		byte days_in_transit;    ///< Age of the packet.
+		SourceType source_type;  ///< Type of the source of the packet.
+		SourceID source_id;      ///< Source of the packet.
+
+		MergeKey(const CargoPacket *cp) : source_xy(cp->source_xy), loaded_at_xy(cp->loaded_at_xy),
+				days_in_transit(cp->days_in_transit), source_type(cp->source_type), source_id(cp->source_id) {}
+
+		bool operator==(const MergeKey &other) const
+		{
+			return this->source_xy == other.source_xy && this->loaded_at_xy == other.loaded_at_xy &&
+					this->days_in_transit == other.days_in_transit &&
+					this->source_type == other.source_type && this->source_id == other.source_id;
+		}
+	};
+
+	/** Hash function for MergeKey. */
+	struct MergeKeyHash {
+		size_t operator()(const MergeKey &key) const
+		{
+			uint64 hash = (uint64)key.source_xy << 32 | key.loaded_at_xy;
+			hash ^= (uint64)key.source_id << 16 ^ (uint64)key.days_in_transit << 8 ^ (uint64)key.source_type;
+			return (size_t)(hash * 0x9E3779B97F4A7C15ULL >> 16);
+		}
+	};
+
 	Money feeder_share;                     ///< Cache for the feeder share.
 	uint action_counts[NUM_MOVE_TO_ACTION]; ///< Counts of cargo to be transferred, delivered, kept and loaded.
 
@@ -394,6 +425,8 @@ public:
 
 	void AgeCargo();
 
+	uint Compact();
+
 	void InvalidateCache();
 
 	void SetTransferLoadPlace(TileIndex xy);
@@ -451,7 +484,55 @@ protected:
 	/** The (direct) parent of this class. */
 	typedef CargoList<StationCargoList, StationCargoPacketMap> Parent;
 
+	/** Properties of a packet that decide which packets it can be merged with, see AreMergable(). */
+	struct MergeKey {
+		StationID next;          ///< Next hop of the packet.
+		TileIndex source_xy;     ///< Origin of the packet.
+		byte days_in_transit;    ///< Age of the packet.
+		SourceType source_type;  ///< Type of the source of the packet.
+		SourceID source_id;      ///< Source of the packet.
+
+		MergeKey(const CargoPacket *cp, StationID next) : next(next), source_xy(cp->source_xy),
+				days_in_transit(cp->days_in_transit), source_type(cp->source_type), source_id(cp->source_id) {}
+
+		bool operator==(const MergeKey &other) const
+		{
+			return this->next == other.next && this->source_xy == other.source_xy &&
+					this->days_in_transit == other.days_in_transit &&
+					this->source_type == other.source_type && this->source_id == other.source_id;
+		}
+	};
+
+	/** Hash function for MergeKey. */
+	struct MergeKeyHash {
+		size_t operator()(const MergeKey &key) const
+		{
+			uint64 hash = (uint64)key.source_xy << 32 | (uint32)key.source_id << 16 | key.next;
+			hash ^= (uint64)key.days_in_transit << 24 ^ (uint64)key.source_type << 8;
+			return (size_t)(hash * 0x9E3779B97F4A7C15ULL >> 16);
+		}
+	};
+
+	/**
+	 * Last packet for each next hop and kind of mergeable packets, so
+	 * appending a packet does not need to search for packets to merge with.
+	 */
+	struct MergeIndex {
+		uint32 generation; ///< Value of #merge_generation the index was built at.
+		std::unordered_map<MergeKey, CargoPacket *, MergeKeyHash> last; ///< Last packet of each kind.
+	};
+
+	static uint32 merge_generation; ///< Incremented when packets change their merge keys, which invalidates all merge indices.
+
 	uint reserved_count; ///< Amount of cargo being reserved for loading.
+	std::unique_ptr<MergeIndex> merge_index; ///< Index of packets to merge with, built when needed.
+
+	MergeIndex *GetMergeIndex();
+	void RemoveFromMergeIndex(const MergeKey &key, const CargoPacket *cp);
+#ifdef WITH_ASSERT
+	void DebugCheckMergeIndex() const;
+#endif
+	void Insert(CargoPacket *cp, StationID next);
 
 public:
 	/** The super class ought to know what it's doing. */
@@ -467,7 +548,11 @@ public:
 	friend class CargoReturn;
 	friend class StationCargoReroute;
 
-	static void InvalidateAllFrom(SourceType src_type, SourceID src);
+	/** Invalidate the merge indices of all station cargo lists, as packets have changed their merge keys. */
+	static inline void InvalidateMergeIndices()
+	{
+		StationCargoList::merge_generation++;
+	}
 
 	template<class Taction>
 	bool ShiftCargo(Taction &action, StationID next);
@@ -477,6 +562,8 @@ public:
 
 	void Append(CargoPacket *cp, StationID next);
 
+	uint Compact();
+
 	/**
 	 * Check for cargo headed for a specific station.
 	 * @param next Station the cargo is headed for.
@@ -554,4 +641,17 @@ public:
 	}
 };
 
+/** Statistics about the cargo packets, for the console and the admin port. */
+struct CargoPacketStatistics {
+	size_t packets;         ///< Number of packets.
+	size_t station_packets; ///< Number of packets waiting at stations.
+	size_t vehicle_packets; ///< Number of packets in vehicles.
+	size_t pool_size;       ///< Number of allocated slots in the pool.
+	size_t memory;          ///< Memory used by the packets and the pool, in bytes.
+	size_t last_compacted;  ///< Number of packets freed by the last compaction.
+};
+
+void CompactCargoPackets();
+CargoPacketStatistics GetCargoPacketStatistics();
+
 #endif /* CARGOPACKET_H */
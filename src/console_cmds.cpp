@@ -45,6 +45,7 @@
 #include "walltime_func.h"
 #include "company_cmd.h"
 #include "misc_cmd.h"
+#include "cargopacket.h"
 
 #include <sstream>
 
@@ -2347,6 +2348,65 @@ DEF_CONSOLE_CMD(ConFramerate)
 	return true;
 }
 
+DEF_CONSOLE_CMD(ConVehicleGrid)
+{
+	extern void ConPrintVehicleGridStatistics(bool reset); // vehicle.cpp
+
+	if (argc == 0 || argc > 2 || (argc == 2 && strcasecmp(argv[1], "reset") != 0)) {
+		IConsolePrint(CC_HELP, "Show statistics of the vehicle position lookups. Usage: 'vehicle_grid [reset]'.");
+		IConsolePrint(CC_HELP, "With 'reset' the search counters are reset after printing.");
+		return true;
+	}
+
+	ConPrintVehicleGridStatistics(argc == 2);
+	return true;
+}
+
+DEF_CONSOLE_CMD(ConYapfCache)
+{
+	extern void ConPrintYapfCacheStatistics(bool reset); // pathfinder/yapf/yapf_rail.cpp
+
+	if (argc == 0 || argc > 2 || (argc == 2 && strcasecmp(argv[1], "reset") != 0)) {
+		IConsolePrint(CC_HELP, "Show statistics of the YAPF rail and road segment cost caches, the train route cache, the depot search caches and the node pools. Usage: 'yapf_cache [reset]'.");
+		IConsolePrint(CC_HELP, "With 'reset' the counters are reset after printing.");
+		return true;
+	}
+
+	ConPrintYapfCacheStatistics(argc == 2);
+	return true;
+}
+
+DEF_CONSOLE_CMD(ConCargoPackets)
+{
+	if (argc == 0) {
+		IConsolePrint(CC_HELP, "Show the number of cargo packets and the memory they use. Usage: 'cargo_packets'.");
+		IConsolePrint(CC_HELP, "Mergeable packets are merged at the start of every month.");
+		return true;
+	}
+
+	CargoPacketStatistics stats = GetCargoPacketStatistics();
+	IConsolePrint(CC_INFO, "Cargo packets: {} of at most {}, {} at stations, {} in vehicles.",
+			stats.packets, CargoPacketPool::MAX_SIZE, stats.station_packets, stats.vehicle_packets);
+	IConsolePrint(CC_INFO, "  {} pool slots allocated, {} KiB used by packets and pool.",
+			stats.pool_size, stats.memory / 1024);
+	IConsolePrint(CC_INFO, "  {} packets freed by the last monthly compaction.", stats.last_compacted);
+	return true;
+}
+
+DEF_CONSOLE_CMD(ConSavegameFormatBenchmark)
+{
+	extern void ConPrintSavegameFormatBenchmark(std::vector<std::string> formats); // saveload/saveload.cpp
+
+	if (argc == 0) {
+		IConsolePrint(CC_HELP, "Compress the current game with each savegame format and show size and timings. Usage: 'savegame_benchmark [<format>[:<level>] ...]'.");
+		IConsolePrint(CC_HELP, "Without formats all available formats are tested at their default compression level.");
+		return true;
+	}
+
+	ConPrintSavegameFormatBenchmark(std::vector<std::string>(argv + 1, argv + argc));
+	return true;
+}
+
 DEF_CONSOLE_CMD(ConFramerateWindow)
 {
 	extern void ShowFramerateWindow();
@@ -2652,6 +2712,10 @@ void IConsoleStdLibRegister()
 #endif
 	IConsole::CmdRegister("fps",                     ConFramerate);
 	IConsole::CmdRegister("fps_wnd",                 ConFramerateWindow);
+	IConsole::CmdRegister("vehicle_grid",            ConVehicleGrid);
+	IConsole::CmdRegister("yapf_cache",              ConYapfCache);
+	IConsole::CmdRegister("cargo_packets",           ConCargoPackets);
+	IConsole::CmdRegister("savegame_benchmark",      ConSavegameFormatBenchmark);
 
 	/* NewGRF development stuff */
 	IConsole::CmdRegister("reload_newgrfs",          ConNewGRFReload,     ConHookNewGRFDeveloperTool);
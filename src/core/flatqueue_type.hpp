@@ -0,0 +1,128 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file flatqueue_type.hpp Sequence in contiguous memory with cheap removal from the front. */
+
+#ifndef FLATQUEUE_TYPE_HPP
+#define FLATQUEUE_TYPE_HPP
+
+#include <iterator>
+#include <vector>
+
+/**
+ * Sequence of items in one block of memory. Items are mostly appended at the
+ * back and taken from the front; taking an item from the front only moves the
+ * start of the sequence, the memory before it is reclaimed once it makes up
+ * half of the block. Iterators are plain pointers, so they are invalidated by
+ * appending and by erasing anything but the first item.
+ * All STL-compatible members are named in STL style.
+ * @tparam T Type of the items.
+ */
+template <typename T>
+class FlatQueue {
+	std::vector<T> items; ///< The items, including the already removed ones before #first.
+	size_t first = 0;     ///< Position of the first item in #items.
+
+public:
+	typedef T value_type;
+	typedef T *iterator;
+	typedef const T *const_iterator;
+	typedef std::reverse_iterator<iterator> reverse_iterator;
+	typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+	inline iterator begin() { return this->items.data() + this->first; }
+	inline const_iterator begin() const { return this->items.data() + this->first; }
+	inline iterator end() { return this->items.data() + this->items.size(); }
+	inline const_iterator end() const { return this->items.data() + this->items.size(); }
+
+	inline reverse_iterator rbegin() { return reverse_iterator(this->end()); }
+	inline const_reverse_iterator rbegin() const { return const_reverse_iterator(this->end()); }
+	inline reverse_iterator rend() { return reverse_iterator(this->begin()); }
+	inline const_reverse_iterator rend() const { return const_reverse_iterator(this->begin()); }
+
+	inline bool empty() const { return this->first == this->items.size(); }
+	inline size_t size() const { return this->items.size() - this->first; }
+
+	inline T &front() { return this->items[this->first]; }
+	inline const T &front() const { return this->items[this->first]; }
+	inline T &back() { return this->items.back(); }
+	inline const T &back() const { return this->items.back(); }
+
+	/**
+	 * Append an item.
+	 * @param item Item to append.
+	 */
+	inline void push_back(const T &item)
+	{
+		this->items.push_back(item);
+	}
+
+	/**
+	 * Erase an item.
+	 * @param pos Iterator pointing at the item.
+	 * @return Iterator to the item after the erased one.
+	 */
+	iterator erase(iterator pos)
+	{
+		if (pos != this->begin()) {
+			return this->items.data() + (this->items.erase(this->items.begin() + (pos - this->items.data())) - this->items.begin());
+		}
+
+		if (++this->first == this->items.size()) {
+			this->clear();
+		} else if (this->first * 2 >= this->items.size()) {
+			this->items.erase(this->items.begin(), this->items.begin() + this->first);
+			this->first = 0;
+		}
+		return this->begin();
+	}
+
+	/**
+	 * Erase a range of items.
+	 * @param from Iterator pointing at the first item to erase.
+	 * @param to Iterator pointing after the last item to erase.
+	 * @return Iterator to the item after the erased ones.
+	 */
+	iterator erase(iterator from, iterator to)
+	{
+		size_t offset = from - this->items.data();
+		this->items.erase(this->items.begin() + offset, this->items.begin() + (to - this->items.data()));
+		if (this->empty()) this->clear();
+		return this->items.data() + offset;
+	}
+
+	/** Remove all items. */
+	inline void clear()
+	{
+		this->items.clear();
+		this->first = 0;
+	}
+
+	/**
+	 * Replace the items by the given ones.
+	 * @param from Iterator pointing at the first item.
+	 * @param to Iterator pointing after the last item.
+	 */
+	template <typename Tinput_iter>
+	void assign(Tinput_iter from, Tinput_iter to)
+	{
+		this->items.assign(from, to);
+		this->first = 0;
+	}
+
+	/**
+	 * Exchange the items with another queue.
+	 * @param other The other queue.
+	 */
+	inline void swap(FlatQueue &other)
+	{
+		this->items.swap(other.items);
+		std::swap(this->first, other.first);
+	}
+};
+
+#endif /* FLATQUEUE_TYPE_HPP */
@@ -11,7 +11,7 @@
 #define MULTIMAP_HPP
 
 #include <map>
-#include <list>
+#include "flatqueue_type.hpp"
 
 template<typename Tkey, typename Tvalue, typename Tcompare>
 class MultiMap;
@@ -94,8 +94,8 @@ public:
 	{
 		assert(!this->map_iter->second.empty());
 		return this->list_valid ?
-				this->list_iter.operator*() :
-				this->map_iter->second.begin().operator*();
+				*this->list_iter :
+				*this->map_iter->second.begin();
 	}
 
 	/**
@@ -106,8 +106,8 @@ public:
 	{
 		assert(!this->map_iter->second.empty());
 		return this->list_valid ?
-				this->list_iter.operator->() :
-				this->map_iter->second.begin().operator->();
+				&*this->list_iter :
+				&*this->map_iter->second.begin();
 	}
 
 	inline const Tmap_iter &GetMapIter() const { return this->map_iter; }
@@ -131,7 +131,7 @@ public:
 				this->list_valid = false;
 			}
 		} else {
-			this->list_iter = ++(this->map_iter->second.begin());
+			this->list_iter = std::next(this->map_iter->second.begin());
 			if (this->list_iter == this->map_iter->second.end()) {
 				++this->map_iter;
 			} else {
@@ -276,14 +276,15 @@ bool operator!=(const Tmap_iter2 &iter2, const MultiMapIterator<Tmap_iter1, Tlis
 /**
  * Hand-rolled multimap as map of lists. Behaves mostly like a list, but is sorted
  * by Tkey so that you can easily look up ranges of equal keys. Those ranges are
- * internally ordered in a deterministic way (contrary to STL multimap). All
- * STL-compatible members are named in STL style, all others are named in OpenTTD
- * style.
+ * internally ordered in a deterministic way (contrary to STL multimap). The
+ * values with equal keys are stored contiguously, so inserting a value only
+ * keeps iterators into the ranges of other keys valid. All STL-compatible
+ * members are named in STL style, all others are named in OpenTTD style.
  */
 template<typename Tkey, typename Tvalue, typename Tcompare = std::less<Tkey> >
-class MultiMap : public std::map<Tkey, std::list<Tvalue>, Tcompare > {
+class MultiMap : public std::map<Tkey, FlatQueue<Tvalue>, Tcompare > {
 public:
-	typedef typename std::list<Tvalue> List;
+	typedef FlatQueue<Tvalue> List;
 	typedef typename List::iterator ListIterator;
 	typedef typename List::const_iterator ConstListIterator;
 
@@ -239,6 +239,7 @@ static void OnNewMonth()
 	IndustryMonthlyLoop();
 	SubsidyMonthlyLoop();
 	StationMonthlyLoop();
+	CompactCargoPackets();
 	if (_network_server) NetworkServerMonthlyLoop();
 }
 
@@ -22,11 +22,14 @@
 DepotPool _depot_pool("Depot");
 INSTANTIATE_POOL_METHODS(Depot)
 
+uint32 Depot::generation = 0;
+
 /**
  * Clean up a depot
  */
 Depot::~Depot()
 {
+	Depot::generation++;
 	if (CleaningPool()) return;
 
 	if (!IsDepotTile(this->xy) || GetDepotIndex(this->xy) != this->index) {
@@ -24,7 +24,9 @@ struct Depot : DepotPool::PoolItem<&_depot_pool> {
 	uint16 town_cn;    ///< The N-1th depot for this town (consecutive number)
 	Date build_date;   ///< Date of construction
 
-	Depot(TileIndex xy = INVALID_TILE) : xy(xy) {}
+	static uint32 generation; ///< Incremented whenever a depot is built, removed or given to another company, so lists of depots know to update.
+
+	Depot(TileIndex xy = INVALID_TILE) : xy(xy) { Depot::generation++; }
 	~Depot();
 
 	static inline Depot *GetByTile(TileIndex tile)
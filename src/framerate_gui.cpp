@@ -68,19 +68,23 @@ namespace {
 		/** Start time for current accumulation cycle */
 		TimingMeasurement acc_timestamp;
 
+		/** Total duration recorded since the last call to #CollectPerformanceTotals */
+		TimingMeasurement total_duration;
+
 		/**
 		 * Initialize a data element with an expected collection rate
 		 * @param expected_rate
 		 * Expected number of cycles per second of the performance element. Use 1 if unknown or not relevant.
 		 * The rate is used for highlighting slow-running elements in the GUI.
 		 */
-		explicit PerformanceData(double expected_rate) : expected_rate(expected_rate), next_index(0), prev_index(0), num_valid(0) { }
+		explicit PerformanceData(double expected_rate) : expected_rate(expected_rate), next_index(0), prev_index(0), num_valid(0), total_duration(0) { }
 
 		/** Collect a complete measurement, given start and ending times for a processing block */
 		void Add(TimingMeasurement start_time, TimingMeasurement end_time)
 		{
 			this->durations[this->next_index] = end_time - start_time;
 			this->timestamps[this->next_index] = start_time;
+			this->total_duration += end_time - start_time;
 			this->prev_index = this->next_index;
 			this->next_index += 1;
 			if (this->next_index >= NUM_FRAMERATE_POINTS) this->next_index = 0;
@@ -105,6 +109,7 @@ namespace {
 		void AddAccumulate(TimingMeasurement duration)
 		{
 			this->acc_duration += duration;
+			this->total_duration += duration;
 		}
 
 		/** Indicate a pause/expected discontinuity in processing the element */
@@ -1101,6 +1106,19 @@ void ConPrintFramerate()
 	}
 }
 
+/**
+ * Collect the time spent in each performance element since the previous call, and restart counting.
+ * Unlike the circular buffers used for the GUI, this does not lose data when called infrequently.
+ * @param[out] totals Time spent per element, in microseconds.
+ */
+void CollectPerformanceTotals(TimingMeasurement totals[PFE_MAX])
+{
+	for (PerformanceElement e = PFE_FIRST; e < PFE_MAX; e++) {
+		totals[e] = _pf_data[e].total_duration;
+		_pf_data[e].total_duration = 0;
+	}
+}
+
 /**
  * This drains the PFE_SOUND measurement data queue into _pf_data.
  * PFE_SOUND measurements are made by the mixer thread and so cannot be stored
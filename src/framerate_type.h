@@ -21,6 +21,7 @@
  * Third is adding strings for the new element. There is an array in #ConPrintFramerate with strings used for the console command.
  * Additionally, there are two sets of strings in \c english.txt for two GUI uses, also in the #PerformanceElement order.
  * Search for \c STR_FRAMERATE_GAMELOOP and \c STR_FRAMETIME_CAPTION_GAMELOOP in \c english.txt to find those.
+ * The benchmark report of the null video driver has its own list of identifiers in \c video/null_v.cpp.
  *
  * @par
  * Last is actually adding the measurements. There are two ways to measure, either one-shot (a single function/block handling all processing),
@@ -121,5 +122,6 @@ public:
 };
 
 void ShowFramerateWindow();
+void CollectPerformanceTotals(TimingMeasurement totals[PFE_MAX]);
 
 #endif /* FRAMERATE_TYPE_H */
@@ -163,6 +163,7 @@ Industry::~Industry()
 			DeleteOilRig(tile_cur);
 		}
 	}
+	InvalidateStationAcceptanceAroundTiles(this->location);
 
 	if (has_neutral_station) {
 		/* Remove possible docking tiles */
@@ -554,6 +555,25 @@ static bool TransportIndustryGoods(TileIndex tile)
 	return moved_cargo;
 }
 
+/**
+ * Change the graphics of an industry tile, and tell the stations around it
+ * when this changes what the tile accepts.
+ * @param tile Industry tile to change.
+ * @param gfx New graphics of the tile.
+ */
+static void ChangeIndustryTileGfx(TileIndex tile, IndustryGfx gfx)
+{
+	const IndustryTileSpec *old_spec = GetIndustryTileSpec(GetIndustryGfx(tile));
+	SetIndustryGfx(tile, gfx);
+	const IndustryTileSpec *new_spec = GetIndustryTileSpec(GetIndustryGfx(tile));
+
+	if (MemCmpT(old_spec->accepts_cargo, new_spec->accepts_cargo, lengthof(old_spec->accepts_cargo)) != 0 ||
+			MemCmpT(old_spec->acceptance, new_spec->acceptance, lengthof(old_spec->acceptance)) != 0 ||
+			(old_spec->special_flags & INDTILE_SPECIAL_ACCEPTS_ALL_CARGO) != (new_spec->special_flags & INDTILE_SPECIAL_ACCEPTS_ALL_CARGO) ||
+			old_spec->callback_mask != new_spec->callback_mask) {
+		InvalidateStationAcceptanceAroundTiles(TileArea(tile, 1, 1));
+	}
+}
 
 static void AnimateTile_Industry(TileIndex tile)
 {
@@ -665,7 +685,7 @@ static void AnimateTile_Industry(TileIndex tile)
 			IndustryGfx gfx = GetIndustryGfx(tile);
 
 			gfx = (gfx < 155) ? gfx + 1 : 148;
-			SetIndustryGfx(tile, gfx);
+			ChangeIndustryTileGfx(tile, gfx);
 			MarkTileDirtyByTile(tile);
 		}
 		break;
@@ -679,12 +699,12 @@ static void AnimateTile_Industry(TileIndex tile)
 
 			byte m = GetAnimationFrame(tile) + 1;
 			if (m == 4 && (m = 0, ++gfx) == GFX_OILWELL_ANIMATED_3 + 1 && (gfx = GFX_OILWELL_ANIMATED_1, b)) {
-				SetIndustryGfx(tile, GFX_OILWELL_NOT_ANIMATED);
+				ChangeIndustryTileGfx(tile, GFX_OILWELL_NOT_ANIMATED);
 				SetIndustryConstructionStage(tile, 3);
 				DeleteAnimatedTile(tile);
 			} else {
 				SetAnimationFrame(tile, m);
-				SetIndustryGfx(tile, gfx);
+				ChangeIndustryTileGfx(tile, gfx);
 				MarkTileDirtyByTile(tile);
 			}
 		}
@@ -842,7 +862,7 @@ static void TileLoop_Industry(TileIndex tile)
 		if (newgfx != INDUSTRYTILE_NOANIM) {
 			ResetIndustryConstructionStage(tile);
 			SetIndustryCompleted(tile);
-			SetIndustryGfx(tile, newgfx);
+			ChangeIndustryTileGfx(tile, newgfx);
 			MarkTileDirtyByTile(tile);
 			return;
 		}
@@ -853,7 +873,7 @@ static void TileLoop_Industry(TileIndex tile)
 	IndustryGfx newgfx = GetIndustryTileSpec(GetIndustryGfx(tile))->anim_next;
 	if (newgfx != INDUSTRYTILE_NOANIM) {
 		ResetIndustryConstructionStage(tile);
-		SetIndustryGfx(tile, newgfx);
+		ChangeIndustryTileGfx(tile, newgfx);
 		MarkTileDirtyByTile(tile);
 		return;
 	}
@@ -869,7 +889,7 @@ static void TileLoop_Industry(TileIndex tile)
 				case GFX_COPPER_MINE_TOWER_NOT_ANIMATED: gfx = GFX_COPPER_MINE_TOWER_ANIMATED; break;
 				case GFX_GOLD_MINE_TOWER_NOT_ANIMATED:   gfx = GFX_GOLD_MINE_TOWER_ANIMATED;   break;
 			}
-			SetIndustryGfx(tile, gfx);
+			ChangeIndustryTileGfx(tile, gfx);
 			SetAnimationFrame(tile, 0x80);
 			AddAnimatedTile(tile);
 		}
@@ -877,7 +897,7 @@ static void TileLoop_Industry(TileIndex tile)
 
 	case GFX_OILWELL_NOT_ANIMATED:
 		if (Chance16(1, 6)) {
-			SetIndustryGfx(tile, GFX_OILWELL_ANIMATED_1);
+			ChangeIndustryTileGfx(tile, GFX_OILWELL_ANIMATED_1);
 			SetAnimationFrame(tile, 0);
 			AddAnimatedTile(tile);
 		}
@@ -892,7 +912,7 @@ static void TileLoop_Industry(TileIndex tile)
 				case GFX_COPPER_MINE_TOWER_ANIMATED: gfx = GFX_COPPER_MINE_TOWER_NOT_ANIMATED; break;
 				case GFX_GOLD_MINE_TOWER_ANIMATED:   gfx = GFX_GOLD_MINE_TOWER_NOT_ANIMATED;   break;
 			}
-			SetIndustryGfx(tile, gfx);
+			ChangeIndustryTileGfx(tile, gfx);
 			SetIndustryCompleted(tile);
 			SetIndustryConstructionStage(tile, 3);
 			DeleteAnimatedTile(tile);
@@ -1928,6 +1948,7 @@ static void DoCreateNewIndustry(Industry *i, TileIndex tile, IndustryType type,
 	InvalidateWindowData(WC_INDUSTRY_DIRECTORY, 0, IDIWD_FORCE_REBUILD);
 
 	if (!_generating_world) PopulateStationsNearby(i);
+	InvalidateStationAcceptanceAroundTiles(i->location);
 }
 
 /**
@@ -1340,18 +1340,7 @@ static void River_FoundEndNode(AyStar *aystar, OpenListNode *current)
 	}
 }
 
-static const uint RIVER_HASH_SIZE = 8; ///< The number of bits the hash for river finding should have.
-
-/**
- * Simple hash function for river tiles to be used by AyStar.
- * @param tile The tile to hash.
- * @param dir The unused direction.
- * @return The hash for the tile.
- */
-static uint River_Hash(uint tile, uint dir)
-{
-	return GB(TileHash(TileX(tile), TileY(tile)), 0, RIVER_HASH_SIZE);
-}
+static const uint RIVER_HASH_SIZE = 8; ///< The number of bits of the initial size of the hashes used for river finding.
 
 /**
  * Actually build the river between the begin and end tiles using AyStar.
@@ -1373,7 +1362,7 @@ static void BuildRiver(TileIndex begin, TileIndex end, TileIndex spring, bool ma
 	finder.user_target = &end;
 	finder.user_data = &user_data;
 
-	finder.Init(River_Hash, 1 << RIVER_HASH_SIZE);
+	finder.Init(1 << RIVER_HASH_SIZE);
 
 	AyStarNode start;
 	start.tile = begin;
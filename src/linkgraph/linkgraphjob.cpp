@@ -10,6 +10,7 @@
 #include "../stdafx.h"
 #include "../core/pool_func.hpp"
 #include "../window_func.h"
+#include "../thread_pool.h"
 #include "linkgraphjob.h"
 #include "linkgraphschedule.h"
 
@@ -19,6 +20,13 @@
 LinkGraphJobPool _link_graph_job_pool("LinkGraphJob");
 INSTANTIATE_POOL_METHODS(LinkGraphJob)
 
+/**
+ * Workers running the link graph jobs, one per core. The jobs are run in the
+ * order they are spawned, which is also the order they are joined in.
+ * Note: This is defined after the job pool, so it is destroyed before it.
+ */
+static ThreadPool _link_graph_workers("ottd:linkgraph");
+
 /**
  * Static instance of an invalid path.
  * Note: This instance is created on task start.
@@ -55,30 +63,29 @@ void LinkGraphJob::EraseFlows(NodeID from)
 }
 
 /**
- * Spawn a thread if possible and run the link graph job in the thread. If
- * that's not possible run the job right now in the current thread.
+ * Queue the job for running on the link graph workers. If there are no
+ * worker threads the job is run right now in the current thread.
  */
 void LinkGraphJob::SpawnThread()
 {
-	if (!StartNewThread(&this->thread, "ottd:linkgraph", &(LinkGraphSchedule::Run), this)) {
-		/* Of course this will hang a bit.
-		 * On the other hand, if you want to play games which make this hang noticeably
-		 * on a platform without threads then you'll probably get other problems first.
-		 * OK:
-		 * If someone comes and tells me that this hangs for them, I'll implement a
-		 * smaller grained "Step" method for all handlers and add some more ticks where
-		 * "Step" is called. No problem in principle. */
-		LinkGraphSchedule::Run(this);
-	}
+	/* Of course running the job right now will hang a bit.
+	 * On the other hand, if you want to play games which make this hang noticeably
+	 * on a platform without threads then you'll probably get other problems first.
+	 * OK:
+	 * If someone comes and tells me that this hangs for them, I'll implement a
+	 * smaller grained "Step" method for all handlers and add some more ticks where
+	 * "Step" is called. No problem in principle. */
+	this->task = _link_graph_workers.Submit([this]() { LinkGraphSchedule::Run(this); });
 }
 
 /**
- * Join the calling thread with this job's thread if threading is enabled.
+ * Wait until the job has been run by the link graph workers.
  */
 void LinkGraphJob::JoinThread()
 {
-	if (this->thread.joinable()) {
-		this->thread.join();
+	if (this->task.valid()) {
+		this->task.wait();
+		this->task = std::future<void>();
 	}
 }
 
@@ -3,7 +3,6 @@
 #include "../stdafx.h"
 #include "../core/math_func.hpp"
 #include "mcf.h"
-#include <set>
 
 #include "../safeguards.h"
 
@@ -14,35 +13,20 @@ typedef std::map<NodeID, Path *> PathViaMap;
  * to the original meaning of "annotation" in this context. Paths are rated
  * according to the sum of distances of their edges.
  */
-class DistanceAnnotation : public Path {
+class DistanceAnnotation {
 public:
+	typedef uint Type; ///< Type of the annotation value.
 
-	/**
-	 * Constructor.
-	 * @param n ID of node to be annotated.
-	 * @param source If the node is the source of its path.
-	 */
-	DistanceAnnotation(NodeID n, bool source = false) : Path(n, source) {}
-
-	bool IsBetter(const DistanceAnnotation *base, uint cap, int free_cap, uint dist) const;
+	static bool IsBetter(const Path *path, const Path *base, uint cap, int free_cap, uint dist);
 
 	/**
 	 * Return the actual value of the annotation, in this case the distance.
+	 * @param path Path to get the annotation for.
 	 * @return Distance.
 	 */
-	inline uint GetAnnotation() const { return this->distance; }
+	static inline uint GetAnnotation(const Path *path) { return path->GetDistance(); }
 
-	/**
-	 * Update the cached annotation value
-	 */
-	inline void UpdateAnnotation() { }
-
-	/**
-	 * Comparator for std containers.
-	 */
-	struct Comparator {
-		bool operator()(const DistanceAnnotation *x, const DistanceAnnotation *y) const;
-	};
+	static bool IsPreferred(uint x_anno, uint y_anno, NodeID x, NodeID y);
 };
 
 /**
@@ -51,40 +35,147 @@ public:
  * algorithm still gives meaningful results like this as the capacity of a path
  * can only decrease or stay the same if you add more edges.
  */
-class CapacityAnnotation : public Path {
-	int cached_annotation;
-
+class CapacityAnnotation {
 public:
+	typedef int Type; ///< Type of the annotation value.
+
+	static bool IsBetter(const Path *path, const Path *base, uint cap, int free_cap, uint dist);
 
 	/**
-	 * Constructor.
-	 * @param n ID of node to be annotated.
-	 * @param source If the node is the source of its path.
+	 * Return the actual value of the annotation, in this case the capacity.
+	 * @param path Path to get the annotation for.
+	 * @return Capacity.
 	 */
-	CapacityAnnotation(NodeID n, bool source = false) : Path(n, source) {}
+	static inline int GetAnnotation(const Path *path) { return path->GetCapacityRatio(); }
 
-	bool IsBetter(const CapacityAnnotation *base, uint cap, int free_cap, uint dist) const;
+	static bool IsPreferred(int x_anno, int y_anno, NodeID x, NodeID y);
+};
+
+/**
+ * Priority queue of the nodes to be visited by the Dijkstra algorithm. It is
+ * a binary heap over node IDs, with the annotation values in a flat array
+ * indexed by node. The position of every node in the heap is tracked, so the
+ * annotation of a node can be changed in place.
+ * @tparam Tannotation Annotation to order the nodes by.
+ */
+template <class Tannotation>
+class AnnotationQueue {
+private:
+	typedef typename Tannotation::Type Value;
+
+	static constexpr uint NOT_QUEUED = UINT_MAX; ///< Position of nodes that are not in the queue.
+
+	std::vector<Value> annotations; ///< Annotation value of each node.
+	std::vector<NodeID> heap;       ///< The heap of nodes, the preferred one first.
+	std::vector<uint> positions;    ///< Position of each node in the heap.
 
 	/**
-	 * Return the actual value of the annotation, in this case the capacity.
-	 * @return Capacity.
+	 * Check if a node has to be visited before another one.
+	 * @param x First node.
+	 * @param y Second node, different from the first.
+	 * @return If x has to be visited first.
 	 */
-	inline int GetAnnotation() const { return this->cached_annotation; }
+	inline bool IsPreferred(NodeID x, NodeID y) const
+	{
+		return Tannotation::IsPreferred(this->annotations[x], this->annotations[y], x, y);
+	}
 
 	/**
-	 * Update the cached annotation value
+	 * Put a node at a position in the heap.
+	 * @param pos Position to put the node at.
+	 * @param node The node.
 	 */
-	inline void UpdateAnnotation()
+	inline void Place(uint pos, NodeID node)
 	{
-		this->cached_annotation = this->GetCapacityRatio();
+		this->heap[pos] = node;
+		this->positions[node] = pos;
+	}
+
+	/**
+	 * Move a node towards the front of the heap until it is in the right place.
+	 * @param pos Current position of the node.
+	 * @return New position of the node.
+	 */
+	uint SiftUp(uint pos)
+	{
+		NodeID node = this->heap[pos];
+		while (pos > 0) {
+			uint parent = (pos - 1) / 2;
+			if (!this->IsPreferred(node, this->heap[parent])) break;
+			this->Place(pos, this->heap[parent]);
+			pos = parent;
+		}
+		this->Place(pos, node);
+		return pos;
 	}
 
 	/**
-	 * Comparator for std containers.
+	 * Move a node towards the back of the heap until it is in the right place.
+	 * @param pos Current position of the node.
 	 */
-	struct Comparator {
-		bool operator()(const CapacityAnnotation *x, const CapacityAnnotation *y) const;
-	};
+	void SiftDown(uint pos)
+	{
+		NodeID node = this->heap[pos];
+		uint size = (uint)this->heap.size();
+		for (;;) {
+			uint child = pos * 2 + 1;
+			if (child >= size) break;
+			if (child + 1 < size && this->IsPreferred(this->heap[child + 1], this->heap[child])) child++;
+			if (!this->IsPreferred(this->heap[child], node)) break;
+			this->Place(pos, this->heap[child]);
+			pos = child;
+		}
+		this->Place(pos, node);
+	}
+
+public:
+	/**
+	 * Create an empty queue.
+	 * @param size Number of nodes in the graph.
+	 */
+	AnnotationQueue(uint16 size) : annotations(size), positions(size, NOT_QUEUED)
+	{
+		this->heap.reserve(size);
+	}
+
+	/**
+	 * Check if there are no nodes left to visit.
+	 * @return If the queue is empty.
+	 */
+	inline bool IsEmpty() const { return this->heap.empty(); }
+
+	/**
+	 * Set the annotation of a node, and queue it if it isn't queued yet.
+	 * @param node The node.
+	 * @param anno The new annotation value.
+	 */
+	void Update(NodeID node, Value anno)
+	{
+		this->annotations[node] = anno;
+		uint pos = this->positions[node];
+		if (pos == NOT_QUEUED) {
+			pos = (uint)this->heap.size();
+			this->heap.push_back(node);
+		}
+		if (this->SiftUp(pos) == pos) this->SiftDown(pos);
+	}
+
+	/**
+	 * Take the preferred node out of the queue.
+	 * @return The node.
+	 */
+	NodeID Pop()
+	{
+		NodeID node = this->heap.front();
+		this->positions[node] = NOT_QUEUED;
+		NodeID last = this->heap.back();
+		this->heap.pop_back();
+		if (!this->heap.empty()) {
+			this->Place(0, last);
+			this->SiftDown(0);
+		}
+		return node;
+	}
 };
 
 /**
@@ -191,56 +282,56 @@ public:
 
 /**
  * Determines if an extension to the given Path with the given parameters is
- * better than this path.
+ * better than a path.
+ * @param path Path to compare with.
  * @param base Other path.
  * @param free_cap Capacity of the new edge to be added to base.
  * @param dist Distance of the new edge.
- * @return True if base + the new edge would be better than the path associated
- * with this annotation.
+ * @return True if base + the new edge would be better than path.
  */
-bool DistanceAnnotation::IsBetter(const DistanceAnnotation *base, uint cap,
-		int free_cap, uint dist) const
+/* static */ bool DistanceAnnotation::IsBetter(const Path *path, const Path *base, uint cap,
+		int free_cap, uint dist)
 {
 	/* If any of the paths is disconnected, the other one is better. If both
 	 * are disconnected, this path is better.*/
-	if (base->distance == UINT_MAX) {
+	if (base->GetDistance() == UINT_MAX) {
 		return false;
-	} else if (this->distance == UINT_MAX) {
+	} else if (path->GetDistance() == UINT_MAX) {
 		return true;
 	}
 
-	if (free_cap > 0 && base->free_capacity > 0) {
+	if (free_cap > 0 && base->GetFreeCapacity() > 0) {
 		/* If both paths have capacity left, compare their distances.
 		 * If the other path has capacity left and this one hasn't, the
 		 * other one's better (thus, return true). */
-		return this->free_capacity > 0 ? (base->distance + dist < this->distance) : true;
+		return path->GetFreeCapacity() > 0 ? (base->GetDistance() + dist < path->GetDistance()) : true;
 	} else {
 		/* If the other path doesn't have capacity left, but this one has,
 		 * the other one is worse (thus, return false).
 		 * If both paths are out of capacity, do the regular distance
 		 * comparison. */
-		return this->free_capacity > 0 ? false : (base->distance + dist < this->distance);
+		return path->GetFreeCapacity() > 0 ? false : (base->GetDistance() + dist < path->GetDistance());
 	}
 }
 
 /**
  * Determines if an extension to the given Path with the given parameters is
- * better than this path.
+ * better than a path.
+ * @param path Path to compare with.
  * @param base Other path.
  * @param free_cap Capacity of the new edge to be added to base.
  * @param dist Distance of the new edge.
- * @return True if base + the new edge would be better than the path associated
- * with this annotation.
+ * @return True if base + the new edge would be better than path.
  */
-bool CapacityAnnotation::IsBetter(const CapacityAnnotation *base, uint cap,
-		int free_cap, uint dist) const
+/* static */ bool CapacityAnnotation::IsBetter(const Path *path, const Path *base, uint cap,
+		int free_cap, uint dist)
 {
-	int min_cap = Path::GetCapacityRatio(std::min(base->free_capacity, free_cap), std::min(base->capacity, cap));
-	int this_cap = this->GetCapacityRatio();
+	int min_cap = Path::GetCapacityRatio(std::min(base->GetFreeCapacity(), free_cap), std::min(base->GetCapacity(), cap));
+	int this_cap = path->GetCapacityRatio();
 	if (min_cap == this_cap) {
 		/* If the capacities are the same and the other path isn't disconnected
 		 * choose the shorter path. */
-		return base->distance == UINT_MAX ? false : (base->distance + dist < this->distance);
+		return base->GetDistance() == UINT_MAX ? false : (base->GetDistance() + dist < path->GetDistance());
 	} else {
 		return min_cap > this_cap;
 	}
@@ -258,22 +349,18 @@ bool CapacityAnnotation::IsBetter(const CapacityAnnotation *base, uint cap,
 template<class Tannotation, class Tedge_iterator>
 void MultiCommodityFlow::Dijkstra(NodeID source_node, PathVector &paths)
 {
-	typedef std::set<Tannotation *, typename Tannotation::Comparator> AnnoSet;
 	Tedge_iterator iter(this->job);
 	uint16 size = this->job.Size();
-	AnnoSet annos;
+	AnnotationQueue<Tannotation> annos(size);
 	paths.resize(size, nullptr);
 	for (NodeID node = 0; node < size; ++node) {
-		Tannotation *anno = new Tannotation(node, node == source_node);
-		anno->UpdateAnnotation();
-		annos.insert(anno);
+		Path *anno = this->NewPath(node, node == source_node);
+		annos.Update(node, Tannotation::GetAnnotation(anno));
 		paths[node] = anno;
 	}
-	while (!annos.empty()) {
-		typename AnnoSet::iterator i = annos.begin();
-		Tannotation *source = *i;
-		annos.erase(i);
-		NodeID from = source->GetNode();
+	while (!annos.IsEmpty()) {
+		NodeID from = annos.Pop();
+		Path *source = paths[from];
 		iter.SetNode(source_node, from);
 		for (NodeID to = iter.Next(); to != INVALID_NODE; to = iter.Next()) {
 			if (to == from) continue; // Not a real edge but a consumption sign.
@@ -295,17 +382,31 @@ void MultiCommodityFlow::Dijkstra(NodeID source_node, PathVector &paths)
 			uint time = (edge.TravelTime() != 0) ? edge.TravelTime() + DAY_TICKS : distance * DAY_TICKS;
 			uint distance_anno = express ? time : distance;
 
-			Tannotation *dest = static_cast<Tannotation *>(paths[to]);
-			if (dest->IsBetter(source, capacity, capacity - edge.Flow(), distance_anno)) {
-				annos.erase(dest);
+			Path *dest = paths[to];
+			if (Tannotation::IsBetter(dest, source, capacity, capacity - edge.Flow(), distance_anno)) {
 				dest->Fork(source, capacity, capacity - edge.Flow(), distance_anno);
-				dest->UpdateAnnotation();
-				annos.insert(dest);
+				annos.Update(to, Tannotation::GetAnnotation(dest));
 			}
 		}
 	}
 }
 
+/**
+ * Get a new path leg, reusing one that has been cleaned up before if possible.
+ * @param node Node the leg passes.
+ * @param source If the leg is the first one of the path.
+ * @return The path leg.
+ */
+Path *MultiCommodityFlow::NewPath(NodeID node, bool source)
+{
+	if (this->spare_paths.empty()) return new Path(node, source);
+
+	Path *path = this->spare_paths.back();
+	this->spare_paths.pop_back();
+	*path = Path(node, source);
+	return path;
+}
+
 /**
  * Clean up paths that lead nowhere and the root path.
  * @param source_id ID of the root node.
@@ -324,12 +425,12 @@ void MultiCommodityFlow::CleanupPaths(NodeID source_id, PathVector &paths)
 			path->Detach();
 			if (path->GetNumChildren() == 0) {
 				paths[path->GetNode()] = nullptr;
-				delete path;
+				this->spare_paths.push_back(path);
 			}
 			path = parent;
 		}
 	}
-	delete source;
+	this->spare_paths.push_back(source);
 	paths.clear();
 }
 
@@ -580,9 +681,9 @@ MCF2ndPass::MCF2ndPass(LinkGraphJob &job) : MultiCommodityFlow(job)
 
 /**
  * Relation that creates a weak order without duplicates.
- * Avoid accidentally deleting different paths of the same capacity/distance in
- * a set. When the annotation is the same node IDs are compared, so there are
- * no equal ranges.
+ * This makes the order in which the Dijkstra algorithm visits nodes with the
+ * same capacity/distance well defined. When the annotation is the same node
+ * IDs are compared, so there are no equal ranges.
  * @tparam T Type to be compared on.
  * @param x_anno First value.
  * @param y_anno Second value.
@@ -599,26 +700,26 @@ bool Greater(T x_anno, T y_anno, NodeID x, NodeID y)
 
 /**
  * Compare two capacity annotations.
- * @param x First capacity annotation.
- * @param y Second capacity annotation.
+ * @param x_anno First capacity annotation.
+ * @param y_anno Second capacity annotation.
+ * @param x Node the first annotation belongs to.
+ * @param y Node the second annotation belongs to, different from x.
  * @return If x is better than y.
  */
-bool CapacityAnnotation::Comparator::operator()(const CapacityAnnotation *x,
-		const CapacityAnnotation *y) const
+/* static */ bool CapacityAnnotation::IsPreferred(int x_anno, int y_anno, NodeID x, NodeID y)
 {
-	return x != y && Greater<int>(x->GetAnnotation(), y->GetAnnotation(),
-			x->GetNode(), y->GetNode());
+	return Greater<int>(x_anno, y_anno, x, y);
 }
 
 /**
  * Compare two distance annotations.
- * @param x First distance annotation.
- * @param y Second distance annotation.
+ * @param x_anno First distance annotation.
+ * @param y_anno Second distance annotation.
+ * @param x Node the first annotation belongs to.
+ * @param y Node the second annotation belongs to, different from x.
  * @return If x is better than y.
  */
-bool DistanceAnnotation::Comparator::operator()(const DistanceAnnotation *x,
-		const DistanceAnnotation *y) const
+/* static */ bool DistanceAnnotation::IsPreferred(uint x_anno, uint y_anno, NodeID x, NodeID y)
 {
-	return x != y && !Greater<uint>(x->GetAnnotation(), y->GetAnnotation(),
-			x->GetNode(), y->GetNode());
+	return !Greater<uint>(x_anno, y_anno, x, y);
 }
@@ -21,15 +21,26 @@ protected:
 			max_saturation(job.Settings().short_path_saturation)
 	{}
 
+	/**
+	 * Destructor. Frees the path legs kept for reuse.
+	 */
+	~MultiCommodityFlow()
+	{
+		for (Path *path : this->spare_paths) delete path;
+	}
+
 	template<class Tannotation, class Tedge_iterator>
 	void Dijkstra(NodeID from, PathVector &paths);
 
+	Path *NewPath(NodeID node, bool source);
+
 	uint PushFlow(Edge &edge, Path *path, uint accuracy, uint max_saturation);
 
 	void CleanupPaths(NodeID source, PathVector &paths);
 
-	LinkGraphJob &job;   ///< Job we're working with.
-	uint max_saturation; ///< Maximum saturation for edges.
+	LinkGraphJob &job;               ///< Job we're working with.
+	uint max_saturation;             ///< Maximum saturation for edges.
+	std::vector<Path *> spare_paths; ///< Path legs that have been cleaned up, to be reused by later runs of Dijkstra.
 };
 
 /**
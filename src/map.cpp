@@ -11,6 +11,8 @@
 #include "debug.h"
 #include "core/alloc_func.hpp"
 #include "water_map.h"
+#include "pathfinder/water_regions.h"
+#include "signal_func.h"
 #include "string_func.h"
 
 #include "safeguards.h"
@@ -27,8 +29,73 @@ uint _map_size_y;    ///< Size of the map along the Y
 uint _map_size;      ///< The number of tiles on the map
 uint _map_tile_mask; ///< _map_size - 1 (to mask the mapsize)
 
-Tile *_m = nullptr;          ///< Tiles of the map
-TileExtended *_me = nullptr; ///< Extended Tiles of the map
+TileColumns _m;          ///< Tiles of the map
+TileExtendedColumns _me; ///< Extended Tiles of the map
+
+
+/**
+ * (Re)allocate the storage for the given number of tiles, all zeroed.
+ * @param size The number of tiles.
+ */
+void TileColumns::Allocate(size_t size)
+{
+	free(this->type);
+	free(this->height);
+	free(this->m2);
+	free(this->m1);
+	free(this->m3);
+	free(this->m4);
+	free(this->m5);
+
+	this->type   = CallocT<byte>(size);
+	this->height = CallocT<byte>(size);
+	this->m2     = CallocT<uint16>(size);
+	this->m1     = CallocT<byte>(size);
+	this->m3     = CallocT<byte>(size);
+	this->m4     = CallocT<byte>(size);
+	this->m5     = CallocT<byte>(size);
+}
+
+/**
+ * Zero the data of the first tiles.
+ * @param size The number of tiles to clear.
+ */
+void TileColumns::Clear(size_t size)
+{
+	MemSetT(this->type, 0, size);
+	MemSetT(this->height, 0, size);
+	MemSetT(this->m2, 0, size);
+	MemSetT(this->m1, 0, size);
+	MemSetT(this->m3, 0, size);
+	MemSetT(this->m4, 0, size);
+	MemSetT(this->m5, 0, size);
+}
+
+/**
+ * (Re)allocate the storage for the given number of tiles, all zeroed.
+ * @param size The number of tiles.
+ */
+void TileExtendedColumns::Allocate(size_t size)
+{
+	free(this->m6);
+	free(this->m7);
+	free(this->m8);
+
+	this->m6 = CallocT<byte>(size);
+	this->m7 = CallocT<byte>(size);
+	this->m8 = CallocT<uint16>(size);
+}
+
+/**
+ * Zero the extended data of the first tiles.
+ * @param size The number of tiles to clear.
+ */
+void TileExtendedColumns::Clear(size_t size)
+{
+	MemSetT(this->m6, 0, size);
+	MemSetT(this->m7, 0, size);
+	MemSetT(this->m8, 0, size);
+}
 
 
 /**
@@ -56,11 +123,12 @@ void AllocateMap(uint size_x, uint size_y)
 	_map_size = size_x * size_y;
 	_map_tile_mask = _map_size - 1;
 
-	free(_m);
-	free(_me);
+	_m.Allocate(_map_size);
+	_me.Allocate(_map_size);
 
-	_m = CallocT<Tile>(_map_size);
-	_me = CallocT<TileExtended>(_map_size);
+	AllocateWaterRegions();
+	InvalidateAllSignalBlocks();
+	InvalidateReservationIndex();
 }
 
 
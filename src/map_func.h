@@ -26,20 +26,18 @@ extern uint _map_tile_mask;
 #define TILE_MASK(x) ((x) & _map_tile_mask)
 
 /**
- * Pointer to the tile-array.
+ * The tile-array.
  *
- * This variable points to the tile-array which contains the tiles of
- * the map.
+ * This variable contains the tiles of the map.
  */
-extern Tile *_m;
+extern TileColumns _m;
 
 /**
- * Pointer to the extended tile-array.
+ * The extended tile-array.
  *
- * This variable points to the extended tile-array which contains the tiles
- * of the map.
+ * This variable contains the extended data of the tiles of the map.
  */
-extern TileExtended *_me;
+extern TileExtendedColumns _me;
 
 void AllocateMap(uint size_x, uint size_y);
 
@@ -13,27 +13,79 @@
 /**
  * Data that is stored per tile. Also used TileExtended for this.
  * Look at docs/landscape.html for the exact meaning of the members.
+ *
+ * The map itself is stored per field (see #TileColumns); this only bundles
+ * references to the fields of a single tile.
  */
 struct Tile {
-	byte   type;        ///< The type (bits 4..7), bridges (2..3), rainforest/desert (0..1)
-	byte   height;      ///< The height of the northern corner.
-	uint16 m2;          ///< Primarily used for indices to towns, industries and stations
-	byte   m1;          ///< Primarily used for ownership information
-	byte   m3;          ///< General purpose
-	byte   m4;          ///< General purpose
-	byte   m5;          ///< General purpose
+	byte   &type;       ///< The type (bits 4..7), bridges (2..3), rainforest/desert (0..1)
+	byte   &height;     ///< The height of the northern corner.
+	uint16 &m2;         ///< Primarily used for indices to towns, industries and stations
+	byte   &m1;         ///< Primarily used for ownership information
+	byte   &m3;         ///< General purpose
+	byte   &m4;         ///< General purpose
+	byte   &m5;         ///< General purpose
 };
 
-static_assert(sizeof(Tile) == 8);
+/**
+ * Storage of the #Tile data of the map, with a separate array for each field.
+ * Loops over many tiles usually only look at one or two fields, e.g. the type
+ * and height, so this way they do not pull the other fields into the cache.
+ */
+struct TileColumns {
+	byte   *type   = nullptr; ///< Storage of Tile::type.
+	byte   *height = nullptr; ///< Storage of Tile::height.
+	uint16 *m2     = nullptr; ///< Storage of Tile::m2.
+	byte   *m1     = nullptr; ///< Storage of Tile::m1.
+	byte   *m3     = nullptr; ///< Storage of Tile::m3.
+	byte   *m4     = nullptr; ///< Storage of Tile::m4.
+	byte   *m5     = nullptr; ///< Storage of Tile::m5.
+
+	/**
+	 * Get the data of a tile.
+	 * @param t The index of the tile.
+	 * @return The fields of the tile.
+	 */
+	inline Tile operator[](size_t t) const
+	{
+		return { this->type[t], this->height[t], this->m2[t], this->m1[t], this->m3[t], this->m4[t], this->m5[t] };
+	}
+
+	void Allocate(size_t size);
+	void Clear(size_t size);
+};
 
 /**
  * Data that is stored per tile. Also used Tile for this.
  * Look at docs/landscape.html for the exact meaning of the members.
+ *
+ * The map itself is stored per field (see #TileExtendedColumns); this only
+ * bundles references to the fields of a single tile.
  */
 struct TileExtended {
-	byte m6;   ///< General purpose
-	byte m7;   ///< Primarily used for newgrf support
-	uint16 m8; ///< General purpose
+	byte   &m6; ///< General purpose
+	byte   &m7; ///< Primarily used for newgrf support
+	uint16 &m8; ///< General purpose
+};
+
+/** Storage of the #TileExtended data of the map, with a separate array for each field. */
+struct TileExtendedColumns {
+	byte   *m6 = nullptr; ///< Storage of TileExtended::m6.
+	byte   *m7 = nullptr; ///< Storage of TileExtended::m7.
+	uint16 *m8 = nullptr; ///< Storage of TileExtended::m8.
+
+	/**
+	 * Get the extended data of a tile.
+	 * @param t The index of the tile.
+	 * @return The fields of the tile.
+	 */
+	inline TileExtended operator[](size_t t) const
+	{
+		return { this->m6[t], this->m7[t], this->m8[t] };
+	}
+
+	void Allocate(size_t size);
+	void Clear(size_t size);
 };
 
 /**
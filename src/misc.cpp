@@ -48,6 +48,7 @@ void InitializeGraphGui();
 void InitializeObjectGui();
 void InitializeTownGui();
 void InitializeIndustries();
+void InitializeStations();
 void InitializeObjects();
 void InitializeTrees();
 void InitializeCompanies();
@@ -103,6 +104,7 @@ void InitializeGame(uint size_x, uint size_y, bool reset_date, bool reset_settin
 	InitializeAIGui();
 	InitializeTrees();
 	InitializeIndustries();
+	InitializeStations();
 	InitializeObjects();
 	InitializeBuildingCounts();
 
@@ -146,12 +146,14 @@ protected:
 	 */
 	typedef CHashTableSlotT<Titem_> Slot;
 
-	Slot  m_slots[Tcapacity]; // here we store our data (array of blobs)
-	int   m_num_items;        // item counter
+	Slot   m_slots[Tcapacity];            // here we store our data (array of blobs)
+	uint32 m_slot_generations[Tcapacity]; // generation each slot was last used in; slots of older generations are empty
+	uint32 m_generation;                  // current generation, see Reset()
+	int    m_num_items;                   // item counter
 
 public:
 	/* default constructor */
-	inline CHashTableT() : m_num_items(0)
+	inline CHashTableT() : m_slot_generations(), m_generation(0), m_num_items(0)
 	{
 	}
 
@@ -172,6 +174,22 @@ protected:
 		return CalcHash(item.GetKey());
 	}
 
+	/** return the slot with the given hash, emptied first if it was last used before Reset() */
+	inline Slot &GetSlot(int hash)
+	{
+		if (m_slot_generations[hash] != m_generation) {
+			m_slots[hash].Clear();
+			m_slot_generations[hash] = m_generation;
+		}
+		return m_slots[hash];
+	}
+
+	/** return the slot with the given hash, or nullptr if it was last used before Reset() */
+	inline const Slot *FindSlot(int hash) const
+	{
+		return m_slot_generations[hash] == m_generation ? &m_slots[hash] : nullptr;
+	}
+
 public:
 	/** item count */
 	inline int Count() const
@@ -185,12 +203,25 @@ public:
 		for (int i = 0; i < Tcapacity; i++) m_slots[i].Clear();
 	}
 
+	/**
+	 * Forget all items and reset the item counter in constant time.
+	 *  The slots are only emptied when they are used again.
+	 */
+	inline void Reset()
+	{
+		m_num_items = 0;
+		if (++m_generation != 0) return;
+		/* The generations wrapped around, so old slots could look current. */
+		Clear();
+		for (int i = 0; i < Tcapacity; i++) m_slot_generations[i] = 0;
+	}
+
 	/** const item search */
 	const Titem_ *Find(const Tkey &key) const
 	{
-		int hash = CalcHash(key);
-		const Slot &slot = m_slots[hash];
-		const Titem_ *item = slot.Find(key);
+		const Slot *slot = FindSlot(CalcHash(key));
+		if (slot == nullptr) return nullptr;
+		const Titem_ *item = slot->Find(key);
 		return item;
 	}
 
@@ -198,7 +229,7 @@ public:
 	Titem_ *Find(const Tkey &key)
 	{
 		int hash = CalcHash(key);
-		Slot &slot = m_slots[hash];
+		Slot &slot = GetSlot(hash);
 		Titem_ *item = slot.Find(key);
 		return item;
 	}
@@ -207,7 +238,7 @@ public:
 	Titem_ *TryPop(const Tkey &key)
 	{
 		int hash = CalcHash(key);
-		Slot &slot = m_slots[hash];
+		Slot &slot = GetSlot(hash);
 		Titem_ *item = slot.Detach(key);
 		if (item != nullptr) {
 			m_num_items--;
@@ -228,7 +259,7 @@ public:
 	{
 		const Tkey &key = item.GetKey();
 		int hash = CalcHash(key);
-		Slot &slot = m_slots[hash];
+		Slot &slot = GetSlot(hash);
 		bool ret = slot.Detach(item);
 		if (ret) {
 			m_num_items--;
@@ -247,7 +278,7 @@ public:
 	void Push(Titem_ &new_item)
 	{
 		int hash = CalcHash(new_item);
-		Slot &slot = m_slots[hash];
+		Slot &slot = GetSlot(hash);
 		assert(slot.Find(new_item.GetKey()) == nullptr);
 		slot.Attach(new_item);
 		m_num_items++;
@@ -178,6 +178,8 @@ protected:
 	 * string  Name of the client (max NETWORK_NAME_LENGTH).
 	 * uint8   ID of the company to play as (1..MAX_COMPANIES).
 	 * uint8   ID of the clients Language.
+	 * uint8   Number of savegame formats the client can load.
+	 * uint32  Tag of each of these savegame formats.
 	 * @param p The packet that was just received.
 	 */
 	virtual NetworkRecvStatus Receive_CLIENT_JOIN(Packet *p);
@@ -21,6 +21,7 @@
 #include "../map_func.h"
 #include "../rev.h"
 #include "../game/game.hpp"
+#include "../cargopacket.h"
 
 #include "../safeguards.h"
 
@@ -53,6 +54,7 @@ static const AdminUpdateFrequency _admin_update_type_frequencies[] = {
 	ADMIN_FREQUENCY_POLL,                                                                                                                                  ///< ADMIN_UPDATE_CMD_NAMES
 	                       ADMIN_FREQUENCY_AUTOMATIC,                                                                                                      ///< ADMIN_UPDATE_CMD_LOGGING
 	                       ADMIN_FREQUENCY_AUTOMATIC,                                                                                                      ///< ADMIN_UPDATE_GAMESCRIPT
+	ADMIN_FREQUENCY_POLL |                                                  ADMIN_FREQUENCY_MONTHLY | ADMIN_FREQUENCY_QUARTERLY | ADMIN_FREQUENCY_ANUALLY, ///< ADMIN_UPDATE_CARGO_PACKETS
 };
 /** Sanity check. */
 static_assert(lengthof(_admin_update_type_frequencies) == ADMIN_UPDATE_END);
@@ -577,6 +579,25 @@ NetworkRecvStatus ServerNetworkAdminSocketHandler::SendGameScript(const std::str
 	return NETWORK_RECV_STATUS_OKAY;
 }
 
+/** Send statistics about the cargo packets. */
+NetworkRecvStatus ServerNetworkAdminSocketHandler::SendCargoPackets()
+{
+	CargoPacketStatistics stats = GetCargoPacketStatistics();
+
+	Packet *p = new Packet(ADMIN_PACKET_SERVER_CARGO_PACKETS);
+
+	p->Send_uint64(stats.packets);
+	p->Send_uint64(CargoPacketPool::MAX_SIZE);
+	p->Send_uint64(stats.station_packets);
+	p->Send_uint64(stats.vehicle_packets);
+	p->Send_uint64(stats.memory);
+	p->Send_uint64(stats.last_compacted);
+
+	this->SendPacket(p);
+
+	return NETWORK_RECV_STATUS_OKAY;
+}
+
 /** Send ping-reply (pong) to admin **/
 NetworkRecvStatus ServerNetworkAdminSocketHandler::SendPong(uint32 d1)
 {
@@ -752,6 +773,11 @@ NetworkRecvStatus ServerNetworkAdminSocketHandler::Receive_ADMIN_POLL(Packet *p)
 			this->SendCmdNames();
 			break;
 
+		case ADMIN_UPDATE_CARGO_PACKETS:
+			/* The admin is requesting cargo packet statistics. */
+			this->SendCargoPackets();
+			break;
+
 		default:
 			/* An unsupported "poll" update type. */
 			Debug(net, 1, "[admin] Not supported poll {} ({}) from '{}' ({}).", type, d1, this->admin_name, this->admin_version);
@@ -1018,6 +1044,10 @@ void NetworkAdminUpdate(AdminUpdateFrequency freq)
 						as->SendCompanyStats();
 						break;
 
+					case ADMIN_UPDATE_CARGO_PACKETS:
+						as->SendCargoPackets();
+						break;
+
 					default: NOT_REACHED();
 				}
 			}
@@ -347,6 +347,9 @@ NetworkRecvStatus ClientNetworkGameSocketHandler::SendJoin()
 	p->Send_string(_settings_client.network.client_name); // Client name
 	p->Send_uint8 (_network_join.company);     // PlayAs
 	p->Send_uint8 (0); // Used to be language
+	std::vector<uint32> formats = GetLoadableSavegameFormats();
+	p->Send_uint8 ((uint8)formats.size());
+	for (uint32 format : formats) p->Send_uint32(format);
 	my_client->SendPacket(p);
 	return NETWORK_RECV_STATUS_OKAY;
 }
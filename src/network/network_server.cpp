@@ -562,7 +562,8 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::SendMap()
 		this->last_frame_server = _frame_counter;
 
 		/* Make a dump of the current game */
-		if (SaveWithFilter(this->savegame, true) != SL_OK) usererror("network savedump failed");
+		const std::string &format = _network_savegame_format.empty() ? _savegame_format : _network_savegame_format;
+		if (SaveWithFilter(this->savegame, true, GetSavegameFormatLoadableBy(format, this->savegame_formats)) != SL_OK) usererror("network savedump failed");
 	}
 
 	if (this->status == STATUS_MAP) {
@@ -846,6 +847,9 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::Receive_CLIENT_JOIN(Packet *p)
 
 	std::string client_name = p->Recv_string(NETWORK_CLIENT_NAME_LENGTH);
 	CompanyID playas = (Owner)p->Recv_uint8();
+	p->Recv_uint8(); // Used to be language
+	uint8 num_formats = p->Recv_uint8();
+	for (uint i = 0; i < num_formats; i++) this->savegame_formats.push_back(p->Recv_uint32());
 
 	if (this->HasClientQuit()) return NETWORK_RECV_STATUS_CLIENT_QUIT;
 
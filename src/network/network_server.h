@@ -70,6 +70,7 @@ public:
 	size_t receive_limit;        ///< Amount of bytes that we can receive at this moment
 
 	struct PacketWriter *savegame; ///< Writer used to write the savegame.
+	std::vector<uint32> savegame_formats; ///< Tags of the savegame formats the client can load.
 	NetworkAddress client_address; ///< IP-address of the client (so they can be banned)
 
 	ServerNetworkGameSocketHandler(SOCKET s);
@@ -131,6 +131,7 @@ void BuildObject(ObjectType type, TileIndex tile, CompanyID owner, Town *town, u
 	}
 
 	Object::IncTypeCount(type);
+	if (type == OBJECT_HQ) InvalidateStationAcceptanceAroundTiles(ta);
 	if (spec->flags & OBJECT_FLAG_ANIMATION) TriggerObjectAnimation(o, OAT_BUILT, spec);
 }
 
@@ -167,9 +168,12 @@ void UpdateCompanyHQ(TileIndex tile, uint score)
 	if (score >= 520) val++;
 	if (score >= 720) val++;
 
+	if (GetCompanyHQSize(tile) >= val) return;
+
 	while (GetCompanyHQSize(tile) < val) {
 		IncreaseCompanyHQSize(tile);
 	}
+	InvalidateStationAcceptanceAroundTiles(Object::GetByTile(tile)->location);
 }
 
 /**
@@ -516,6 +520,7 @@ static void ReallyClearObjectTile(Object *o)
 
 		MakeWaterKeepingClass(tile_cur, GetTileOwner(tile_cur));
 	}
+	if (o->type == OBJECT_HQ) InvalidateStationAcceptanceAroundTiles(o->location);
 	delete o;
 }
 
@@ -204,6 +204,8 @@ static void ShowHelp()
 		"  -q savegame         = Write some information about the savegame and exit\n"
 		"  -Q                  = Don't scan for/load NewGRF files on startup\n"
 		"  -QQ                 = Disable NewGRF scanning/loading entirely\n"
+		"  --benchmark savegame= Run the savegame headless and print tick timings as JSON\n"
+		"  --ticks n           = Number of ticks to run for --benchmark (default 1000)\n"
 		"\n",
 		lastof(buf)
 	);
@@ -486,6 +488,25 @@ struct AfterNewGRFScan : NewGRFScanCallback {
 	}
 };
 
+/**
+ * Set the savegame or scenario to load directly after startup.
+ * @param name Name of the file to load.
+ */
+static void SetStartupGameFile(const char *name)
+{
+	_file_to_saveload.SetName(name);
+	bool is_scenario = _switch_mode == SM_EDITOR || _switch_mode == SM_LOAD_SCENARIO;
+	_switch_mode = is_scenario ? SM_LOAD_SCENARIO : SM_LOAD_GAME;
+	_file_to_saveload.SetMode(SLO_LOAD, is_scenario ? FT_SCENARIO : FT_SAVEGAME, DFT_GAME_FILE);
+
+	/* if the file doesn't exist or it is not a valid savegame, let the saveload code show an error */
+	auto t = _file_to_saveload.name.find_last_of('.');
+	if (t != std::string::npos) {
+		FiosType ft = FiosGetSavegameListCallback(SLO_LOAD, _file_to_saveload.name, _file_to_saveload.name.substr(t).c_str(), nullptr, nullptr);
+		if (ft != FIOS_TYPE_INVALID) _file_to_saveload.SetMode(ft);
+	}
+}
+
 #if defined(UNIX)
 extern void DedicatedFork();
 #endif
@@ -519,6 +540,8 @@ static const OptionData _options[] = {
 	 GETOPT_SHORT_VALUE('q'),
 	 GETOPT_SHORT_NOVAL('h'),
 	 GETOPT_SHORT_NOVAL('Q'),
+	GETOPT_GENERAL('B', '\0', "--benchmark", ODF_HAS_VALUE),
+	GETOPT_GENERAL('T', '\0', "--ticks", ODF_HAS_VALUE),
 	GETOPT_END()
 };
 
@@ -542,6 +565,8 @@ int openttd_main(int argc, char *argv[])
 	bool dedicated = false;
 	char *debuglog_conn = nullptr;
 	bool only_local_path = false;
+	bool benchmark = false;
+	int benchmark_ticks = 1000;
 
 	extern bool _dedicated_forks;
 	_dedicated_forks = false;
@@ -598,18 +623,7 @@ int openttd_main(int argc, char *argv[])
 		case 'e': _switch_mode = (_switch_mode == SM_LOAD_GAME || _switch_mode == SM_LOAD_SCENARIO ? SM_LOAD_SCENARIO : SM_EDITOR); break;
 		case 'g':
 			if (mgo.opt != nullptr) {
-				_file_to_saveload.SetName(mgo.opt);
-				bool is_scenario = _switch_mode == SM_EDITOR || _switch_mode == SM_LOAD_SCENARIO;
-				_switch_mode = is_scenario ? SM_LOAD_SCENARIO : SM_LOAD_GAME;
-				_file_to_saveload.SetMode(SLO_LOAD, is_scenario ? FT_SCENARIO : FT_SAVEGAME, DFT_GAME_FILE);
-
-				/* if the file doesn't exist or it is not a valid savegame, let the saveload code show an error */
-				auto t = _file_to_saveload.name.find_last_of('.');
-				if (t != std::string::npos) {
-					FiosType ft = FiosGetSavegameListCallback(SLO_LOAD, _file_to_saveload.name, _file_to_saveload.name.substr(t).c_str(), nullptr, nullptr);
-					if (ft != FIOS_TYPE_INVALID) _file_to_saveload.SetMode(ft);
-				}
-
+				SetStartupGameFile(mgo.opt);
 				break;
 			}
 
@@ -656,6 +670,11 @@ int openttd_main(int argc, char *argv[])
 		case 'c': _config_file = mgo.opt; break;
 		case 'x': scanner->save_config = false; break;
 		case 'X': only_local_path = true; break;
+		case 'B':
+			SetStartupGameFile(mgo.opt);
+			benchmark = true;
+			break;
+		case 'T': benchmark_ticks = atoi(mgo.opt); break;
 		case 'h':
 			i = -2; // Force printing of help.
 			break;
@@ -678,6 +697,13 @@ int openttd_main(int argc, char *argv[])
 		return ret;
 	}
 
+	if (benchmark) {
+		/* Run the game loop without any output, and let the null video driver report the timings. */
+		videodriver = fmt::format("null:ticks={},benchmark", std::max(benchmark_ticks, 1));
+		sounddriver = "null";
+		musicdriver = "null";
+	}
+
 	DeterminePaths(argv[0], only_local_path);
 	TarScanner::DoScan(TarScanner::BASESET);
 
@@ -1325,6 +1351,37 @@ static void CheckCaches()
 			}
 		}
 
+		/* Check rating_cargoes */
+		for (CargoID c = 0; c < NUM_CARGO; c++) {
+			const GoodsEntry &ge = st->goods[c];
+			if (!HasBit(st->rating_cargoes, c) && (ge.HasRating() || ge.rating < INITIAL_STATION_RATING)) {
+				Debug(desync, 2, "station rating cargo mismatch: station {}, cargo {}", st->index, c);
+			}
+		}
+
+		/* Check rating_phase */
+		if ((st->rating_phase != INVALID_RATING_PHASE) != st->IsInUse()) {
+			Debug(desync, 2, "station rating schedule mismatch: station {}", st->index);
+		}
+
+		/* Check catchment_acceptance */
+		if (st->catchment_acceptance_valid && !st->rect.IsEmpty()) {
+			CargoArray acceptance;
+			CargoTypes always_accepted = 0;
+			BitmapTileIterator it(st->catchment_tiles);
+			for (TileIndex tile = it; tile != INVALID_TILE; tile = ++it) {
+				AddAcceptedCargo(tile, acceptance, &always_accepted);
+			}
+			for (CargoID c = 0; c < NUM_CARGO; c++) {
+				if (acceptance[c] != st->catchment_acceptance[c]) {
+					Debug(desync, 2, "station acceptance mismatch: station {}, cargo {}", st->index, c);
+				}
+			}
+			if (always_accepted != st->always_accepted) {
+				Debug(desync, 2, "station always accepted mismatch: station {}", st->index);
+			}
+		}
+
 		/* Check industries_near */
 		IndustryList industries_near = st->industries_near;
 		st->RecomputeCatchment();
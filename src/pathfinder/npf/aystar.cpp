@@ -15,14 +15,12 @@
 
 /*
  * Friendly reminder:
- *  Call (AyStar).free() when you are done with Aystar. It reserves a lot of memory
- *  And when not free'd, it can cause system-crashes.
+ *  Call (AyStar).free() when you are done with Aystar. It reserves a lot of memory.
  * Also remember that when you stop an algorithm before it is finished, your
  * should call clear() yourself!
  */
 
 #include "../../stdafx.h"
-#include "../../core/alloc_func.hpp"
 #include "aystar.h"
 
 #include "../../safeguards.h"
@@ -34,20 +32,18 @@
  */
 PathNode *AyStar::ClosedListIsInList(const AyStarNode *node)
 {
-	return (PathNode*)this->closedlist_hash.Get(node->tile, node->direction);
+	return this->closedlist_hash.Get(node->tile, node->direction);
 }
 
 /**
  * This adds a node to the closed list.
- * It makes a copy of the data.
+ * The node stays where it is, until the search is cleared.
  * @param node Node to add to the closed list.
  */
-void AyStar::ClosedListAdd(const PathNode *node)
+void AyStar::ClosedListAdd(PathNode *node)
 {
 	/* Add a node to the ClosedList */
-	PathNode *new_node = MallocT<PathNode>(1);
-	*new_node = *node;
-	this->closedlist_hash.Set(node->node.tile, node->node.direction, new_node);
+	this->closedlist_hash.Set(node->node.tile, node->node.direction, node);
 }
 
 /**
@@ -57,7 +53,7 @@ void AyStar::ClosedListAdd(const PathNode *node)
  */
 OpenListNode *AyStar::OpenListIsInList(const AyStarNode *node)
 {
-	return (OpenListNode*)this->openlist_hash.Get(node->tile, node->direction);
+	return this->openlist_hash.Get(node->tile, node->direction);
 }
 
 /**
@@ -68,7 +64,7 @@ OpenListNode *AyStar::OpenListIsInList(const AyStarNode *node)
 OpenListNode *AyStar::OpenListPop()
 {
 	/* Return the item the Queue returns.. the best next OpenList item. */
-	OpenListNode *res = (OpenListNode*)this->openlist_queue.Pop();
+	OpenListNode *res = this->openlist_queue.Pop();
 	if (res != nullptr) {
 		this->openlist_hash.DeleteValue(res->path.node.tile, res->path.node.direction);
 	}
@@ -83,10 +79,11 @@ OpenListNode *AyStar::OpenListPop()
 void AyStar::OpenListAdd(PathNode *parent, const AyStarNode *node, int f, int g)
 {
 	/* Add a new Node to the OpenList */
-	OpenListNode *new_node = MallocT<OpenListNode>(1);
+	OpenListNode *new_node = this->nodes.Allocate();
 	new_node->g = g;
 	new_node->path.parent = parent;
 	new_node->path.node = *node;
+	new_node->heap_index = 0;
 	this->openlist_hash.Set(node->tile, node->direction, new_node);
 
 	/* Add it to the queue */
@@ -124,7 +121,7 @@ void AyStar::CheckTile(AyStarNode *current, OpenListNode *parent)
 	/* The f-value if g + h */
 	new_f = new_g + new_h;
 
-	/* Get the pointer to the parent in the ClosedList (the current one is to a copy of the one in the OpenList) */
+	/* Get the pointer to the parent in the ClosedList */
 	closedlist_parent = this->ClosedListIsInList(&parent->path.node);
 
 	/* Check if this item is already in the OpenList */
@@ -133,7 +130,7 @@ void AyStar::CheckTile(AyStarNode *current, OpenListNode *parent)
 		uint i;
 		/* Yes, check if this g value is lower.. */
 		if (new_g > check->g) return;
-		this->openlist_queue.Delete(check, 0);
+		this->openlist_queue.Delete(check);
 		/* It is lower, so change it to this item */
 		check->g = new_g;
 		check->path.parent = closedlist_parent;
@@ -172,7 +169,6 @@ int AyStar::Loop()
 		if (this->FoundEndNode != nullptr) {
 			this->FoundEndNode(this, current);
 		}
-		free(current);
 		return AYSTAR_FOUND_END_NODE;
 	}
 
@@ -188,9 +184,6 @@ int AyStar::Loop()
 		this->CheckTile(&this->neighbours[i], current);
 	}
 
-	/* Free the node */
-	free(current);
-
 	if (this->max_search_nodes != 0 && this->closedlist_hash.GetSize() >= this->max_search_nodes) {
 		/* We've expanded enough nodes */
 		return AYSTAR_LIMIT_REACHED;
@@ -205,11 +198,10 @@ int AyStar::Loop()
  */
 void AyStar::Free()
 {
-	this->openlist_queue.Free(false);
-	/* 2nd argument above is false, below is true, to free the values only
-	 * once */
-	this->openlist_hash.Delete(true);
-	this->closedlist_hash.Delete(true);
+	this->openlist_queue.Free();
+	this->openlist_hash.Free();
+	this->closedlist_hash.Free();
+	this->nodes.Free();
 #ifdef AYSTAR_DEBUG
 	printf("[AyStar] Memory free'd\n");
 #endif
@@ -221,12 +213,11 @@ void AyStar::Free()
  */
 void AyStar::Clear()
 {
-	/* Clean the Queue, but not the elements within. That will be done by
-	 * the hash. */
-	this->openlist_queue.Clear(false);
-	/* Clean the hashes */
-	this->openlist_hash.Clear(true);
-	this->closedlist_hash.Clear(true);
+	/* Clean the queue and the hashes, and release all nodes at once. */
+	this->openlist_queue.Clear();
+	this->openlist_hash.Clear();
+	this->closedlist_hash.Clear();
+	this->nodes.Clear();
 
 #ifdef AYSTAR_DEBUG
 	printf("[AyStar] Cleared AyStar\n");
@@ -289,16 +280,16 @@ void AyStar::AddStartNode(AyStarNode *start_node, uint g)
 /**
  * Initialize an #AyStar. You should fill all appropriate fields before
  * calling #Init (see the declaration of #AyStar for which fields are internal).
+ * @param num_buckets Initial size of the hashes, a power of 2. They grow when needed.
  */
-void AyStar::Init(Hash_HashProc hash, uint num_buckets)
+void AyStar::Init(uint num_buckets)
 {
 	/* Allocated the Hash for the OpenList and ClosedList */
-	this->openlist_hash.Init(hash, num_buckets);
-	this->closedlist_hash.Init(hash, num_buckets);
+	this->openlist_hash.Init(num_buckets);
+	this->closedlist_hash.Init(num_buckets);
 
 	/* Set up our sorting queue
-	 *  BinaryHeap allocates a block of 1024 nodes
-	 *  When that one gets full it reserves another one, till this number
+	 *  The BinaryHeap grows when it gets full, till this number
 	 *  That is why it can stay this high */
 	this->openlist_queue.Init(102400);
 }
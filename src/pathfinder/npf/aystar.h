@@ -55,6 +55,7 @@ struct PathNode {
 struct OpenListNode {
 	int g;
 	PathNode path;
+	uint heap_index; ///< Position in the open queue, see #BinaryHeap.
 };
 
 bool CheckIgnoreFirstTile(const PathNode *node);
@@ -144,7 +145,7 @@ struct AyStar {
 	AyStarNode neighbours[12];
 	byte num_neighbours;
 
-	void Init(Hash_HashProc hash, uint num_buckets);
+	void Init(uint num_buckets);
 
 	/* These will contain the methods for manipulating the AyStar. Only
 	 * Main() should be called externally */
@@ -156,15 +157,16 @@ struct AyStar {
 	void CheckTile(AyStarNode *current, OpenListNode *parent);
 
 protected:
-	Hash       closedlist_hash; ///< The actual closed list.
-	BinaryHeap openlist_queue;  ///< The open queue.
-	Hash       openlist_hash;   ///< An extra hash to speed up the process of looking up an element in the open list.
+	Hash<PathNode>           closedlist_hash; ///< The actual closed list.
+	BinaryHeap<OpenListNode> openlist_queue;  ///< The open queue.
+	Hash<OpenListNode>       openlist_hash;   ///< An extra hash to speed up the process of looking up an element in the open list.
+	NodeArena<OpenListNode>  nodes;           ///< All nodes of the search; the closed list points into them too.
 
 	void OpenListAdd(PathNode *parent, const AyStarNode *node, int f, int g);
 	OpenListNode *OpenListIsInList(const AyStarNode *node);
 	OpenListNode *OpenListPop();
 
-	void ClosedListAdd(const PathNode *node);
+	void ClosedListAdd(PathNode *node);
 	PathNode *ClosedListIsInList(const AyStarNode *node);
 };
 
@@ -5,91 +5,270 @@
  * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
  */
 
-/** @file queue.h Binary heap implementation, hash implementation. */
+/** @file queue.h Binary heap, hash and node arena used by %AyStar. */
 
 #ifndef QUEUE_H
 #define QUEUE_H
 
-//#define HASH_STATS
-
-
-struct BinaryHeapNode {
-	void *item;
-	int priority;
-};
-
+#include <memory>
+#include <vector>
 
 /**
- * Binary Heap.
+ * Binary Heap of pointers to items, the item with the lowest priority on top.
  * For information, see: http://www.policyalmanac.org/games/binaryHeaps.htm
+ *
+ * Items with equal priorities are ordered by the order of the pushes and
+ * deletes, so paths only depend on that order. The heap keeps the position
+ * of each item in its \c heap_index member, so deleting does not need to
+ * search for the item; items that are not in the heap must have 0 there.
+ * @tparam Titem Type of the items.
  */
+template <class Titem>
 struct BinaryHeap {
-	static const int BINARY_HEAP_BLOCKSIZE;
-	static const int BINARY_HEAP_BLOCKSIZE_BITS;
-	static const int BINARY_HEAP_BLOCKSIZE_MASK;
+	/** Element of the heap. */
+	struct Node {
+		Titem *item;
+		int priority;
+	};
+
+	/**
+	 * Initializes the heap.
+	 * @param max_size Maximum number of items in the heap.
+	 */
+	void Init(uint max_size)
+	{
+		this->max_size = max_size;
+		this->elements.clear();
+	}
+
+	/**
+	 * Pushes an item into the heap, at the appropriate place for its priority.
+	 * @param item The item.
+	 * @param priority The priority of the item.
+	 * @return False if the heap is full.
+	 */
+	bool Push(Titem *item, int priority)
+	{
+		if (this->elements.size() == this->max_size) return false;
 
-	void Init(uint max_size);
+		/* Add the item at the end of the array */
+		this->elements.push_back({item, priority});
+		uint i = (uint)this->elements.size();
+		item->heap_index = i;
 
-	bool Push(void *item, int priority);
-	void *Pop();
-	bool Delete(void *item, int priority);
-	void Clear(bool free_values);
-	void Free(bool free_values);
+		/* Now we are going to check where it belongs. As long as the parent is
+		 * bigger, we switch with the parent */
+		while (i > 1) {
+			/* Get the parent of this object (divide by 2) */
+			uint j = i / 2;
+			/* Is the parent bigger than the current, switch them */
+			if (this->GetElement(i).priority > this->GetElement(j).priority) break;
+			this->Swap(i, j);
+			i = j;
+		}
+
+		return true;
+	}
+
+	/**
+	 * Deletes an item from the heap.
+	 * @param item The item.
+	 * @return False if the item is not in the heap.
+	 */
+	bool Delete(Titem *item)
+	{
+		uint i = item->heap_index;
+		if (i == 0 || i > this->elements.size() || this->GetElement(i).item != item) return false;
+
+		/* Now we put the last item over the current item while decreasing the size of the elements */
+		Node last = this->elements.back();
+		this->elements.pop_back();
+		if (i <= this->elements.size()) {
+			this->GetElement(i) = last;
+			last.item->heap_index = i;
+		}
+		item->heap_index = 0;
+
+		/* Now the only thing we have to do, is sort it down from place i. */
+		uint size = (uint)this->elements.size();
+		for (;;) {
+			uint j = i;
+			/* Check if we have 2 children */
+			if (2 * j + 1 <= size) {
+				/* Is this child smaller than the parent? */
+				if (this->GetElement(j).priority >= this->GetElement(2 * j).priority) i = 2 * j;
+				/* Yes, we _need_ to use i here, not j, because we want to have the smallest child
+				 *  This way we get that straight away! */
+				if (this->GetElement(i).priority >= this->GetElement(2 * j + 1).priority) i = 2 * j + 1;
+			/* Do we have one child? */
+			} else if (2 * j <= size) {
+				if (this->GetElement(j).priority >= this->GetElement(2 * j).priority) i = 2 * j;
+			}
+
+			/* None of our children is smaller, so we stay here.. stop :) */
+			if (i == j) break;
+
+			/* One of our children is smaller than we are, switch */
+			this->Swap(i, j);
+		}
+
+		return true;
+	}
+
+	/**
+	 * Pops the item with the lowest priority from the heap.
+	 * @return The item, or \c nullptr when the heap is empty.
+	 */
+	Titem *Pop()
+	{
+		if (this->elements.empty()) return nullptr;
+
+		/* The best item is always on top, so give that as result */
+		Titem *result = this->GetElement(1).item;
+		/* And now we should get rid of this item... */
+		this->Delete(result);
+
+		return result;
+	}
+
+	/** Removes all items from the heap, but keeps its memory. */
+	void Clear()
+	{
+		this->elements.clear();
+	}
+
+	/** Releases the memory of the heap. */
+	void Free()
+	{
+		this->elements.clear();
+		this->elements.shrink_to_fit();
+	}
+
+private:
+	uint max_size;
+	std::vector<Node> elements;
 
 	/**
 	 * Get an element from the #elements.
 	 * @param i Element to access (starts at offset \c 1).
 	 * @return Value of the element.
 	 */
-	inline BinaryHeapNode &GetElement(uint i)
+	inline Node &GetElement(uint i)
 	{
 		assert(i > 0);
-		return this->elements[(i - 1) >> BINARY_HEAP_BLOCKSIZE_BITS][(i - 1) & BINARY_HEAP_BLOCKSIZE_MASK];
+		return this->elements[i - 1];
 	}
 
-	uint max_size;
-	uint size;
-	uint blocks; ///< The amount of blocks for which space is reserved in elements
-	BinaryHeapNode **elements;
+	/** Swap two elements, and their positions in the items. */
+	inline void Swap(uint i, uint j)
+	{
+		std::swap(this->GetElement(i), this->GetElement(j));
+		this->GetElement(i).item->heap_index = i;
+		this->GetElement(j).item->heap_index = j;
+	}
 };
 
 
-/*
- * Hash
- */
-struct HashNode {
-	uint key1;
-	uint key2;
-	void *value;
-	HashNode *next;
-};
 /**
- * Generates a hash code from the given key pair. You should make sure that
- * the resulting range is clearly defined.
+ * Hash from a key pair to pointers to values, with open addressing. The table
+ * grows when it gets too full, so it never overflows.
+ * @tparam Tvalue Type of the values.
  */
-typedef uint Hash_HashProc(uint key1, uint key2);
+template <class Tvalue>
 struct Hash {
-	/* The hash function used */
-	Hash_HashProc *hash;
-	/* The amount of items in the hash */
-	uint size;
-	/* The number of buckets allocated */
-	uint num_buckets;
-	/* A pointer to an array of num_buckets buckets. */
-	HashNode *buckets;
-	/* A pointer to an array of numbuckets booleans, which will be true if
-	 * there are any Nodes in the bucket */
-	bool *buckets_in_use;
+	/**
+	 * Initializes the hash.
+	 * @param num_slots Initial number of slots, a power of 2.
+	 */
+	void Init(uint num_slots)
+	{
+		assert(num_slots >= 2 && (num_slots & (num_slots - 1)) == 0);
+		this->slots.assign(num_slots, Slot{});
+		this->size = 0;
+	}
 
-	void Init(Hash_HashProc *hash, uint num_buckets);
+	/**
+	 * Gets the value associated with the given key pair.
+	 * @return The value, or \c nullptr when it is not present.
+	 */
+	Tvalue *Get(uint key1, uint key2) const
+	{
+		for (uint i = this->GetSlot(key1, key2);; i = this->GetNextSlot(i)) {
+			const Slot &slot = this->slots[i];
+			if (slot.value == nullptr) return nullptr;
+			if (slot.key1 == key1 && slot.key2 == key2) return slot.value;
+		}
+	}
+
+	/**
+	 * Sets the value associated with the given key pair.
+	 * @return The old value if it was replaced, \c nullptr when it was not yet present.
+	 */
+	Tvalue *Set(uint key1, uint key2, Tvalue *value)
+	{
+		assert(value != nullptr);
+		/* Keep at least a quarter of the slots empty, so searches end soon. */
+		if ((this->size + 1) * 4 > this->slots.size() * 3) this->Grow();
+
+		for (uint i = this->GetSlot(key1, key2);; i = this->GetNextSlot(i)) {
+			Slot &slot = this->slots[i];
+			if (slot.value == nullptr) {
+				slot = {key1, key2, value};
+				this->size++;
+				return nullptr;
+			}
+			if (slot.key1 == key1 && slot.key2 == key2) {
+				Tvalue *result = slot.value;
+				slot.value = value;
+				return result;
+			}
+		}
+	}
+
+	/**
+	 * Deletes the value associated with the given key pair.
+	 * @return The value, or \c nullptr when it was not present.
+	 */
+	Tvalue *DeleteValue(uint key1, uint key2)
+	{
+		uint i = this->GetSlot(key1, key2);
+		for (;; i = this->GetNextSlot(i)) {
+			const Slot &slot = this->slots[i];
+			if (slot.value == nullptr) return nullptr;
+			if (slot.key1 == key1 && slot.key2 == key2) break;
+		}
+		Tvalue *result = this->slots[i].value;
 
-	void *Get(uint key1, uint key2) const;
-	void *Set(uint key1, uint key2, void *value);
+		/* Move back the following values that would no longer be found past the emptied slot. */
+		uint hole = i;
+		for (uint j = this->GetNextSlot(i); this->slots[j].value != nullptr; j = this->GetNextSlot(j)) {
+			uint home = this->GetSlot(this->slots[j].key1, this->slots[j].key2);
+			/* Move the value if its home slot is not in between the hole and the value, cyclically. */
+			if (((j - home) & this->GetMask()) >= ((j - hole) & this->GetMask())) {
+				this->slots[hole] = this->slots[j];
+				hole = j;
+			}
+		}
+		this->slots[hole].value = nullptr;
+		this->size--;
+		return result;
+	}
 
-	void *DeleteValue(uint key1, uint key2);
+	/** Removes all values from the hash, but keeps its memory. */
+	void Clear()
+	{
+		if (this->size == 0) return;
+		for (Slot &slot : this->slots) slot.value = nullptr;
+		this->size = 0;
+	}
 
-	void Clear(bool free_values);
-	void Delete(bool free_values);
+	/** Releases the memory of the hash. */
+	void Free()
+	{
+		this->slots.clear();
+		this->slots.shrink_to_fit();
+		this->size = 0;
+	}
 
 	/**
 	 * Gets the current size of the hash.
@@ -99,11 +278,85 @@ struct Hash {
 		return this->size;
 	}
 
-protected:
-#ifdef HASH_STATS
-	void PrintStatistics() const;
-#endif
-	HashNode *FindNode(uint key1, uint key2, HashNode** prev_out) const;
+private:
+	/** Slot of the table; empty when the value is \c nullptr. */
+	struct Slot {
+		uint key1;
+		uint key2;
+		Tvalue *value = nullptr;
+	};
+
+	std::vector<Slot> slots;
+	uint size;
+
+	inline uint GetMask() const
+	{
+		return (uint)this->slots.size() - 1;
+	}
+
+	/** Home slot of a key pair; the keys are mixed so neighbouring tiles get spread over the table. */
+	inline uint GetSlot(uint key1, uint key2) const
+	{
+		return (uint)(((uint64)key1 * 16 + key2) * 0x9E3779B97F4A7C15ULL >> 32) & this->GetMask();
+	}
+
+	inline uint GetNextSlot(uint i) const
+	{
+		return (i + 1) & this->GetMask();
+	}
+
+	/** Double the number of slots. */
+	void Grow()
+	{
+		std::vector<Slot> old_slots(this->slots.size() * 2);
+		old_slots.swap(this->slots);
+		for (const Slot &slot : old_slots) {
+			if (slot.value == nullptr) continue;
+			uint i = this->GetSlot(slot.key1, slot.key2);
+			while (this->slots[i].value != nullptr) i = this->GetNextSlot(i);
+			this->slots[i] = slot;
+		}
+	}
+};
+
+
+/**
+ * Storage for items that are all released at once. Items are allocated in
+ * blocks, so they do not move and the memory is reused by the next search.
+ * @tparam Titem Type of the items.
+ */
+template <class Titem>
+struct NodeArena {
+	static const uint BLOCK_SIZE = 1024; ///< Number of items allocated at a time.
+
+	/**
+	 * Allocate an item.
+	 * @return The item, with undefined contents.
+	 */
+	Titem *Allocate()
+	{
+		uint block = this->used / BLOCK_SIZE;
+		if (block == this->blocks.size()) this->blocks.emplace_back(new Titem[BLOCK_SIZE]);
+		return &this->blocks[block][this->used++ % BLOCK_SIZE];
+	}
+
+	/** Release all items, but keep the memory. */
+	void Clear()
+	{
+		this->used = 0;
+	}
+
+	/** Release the memory of the arena. */
+	void Free()
+	{
+		this->blocks.clear();
+		this->blocks.shrink_to_fit();
+		this->used = 0;
+	}
+
+private:
+	std::vector<std::unique_ptr<Titem[]>> blocks;
+	uint used = 0; ///< Number of items in use.
 };
 
 #endif /* QUEUE_H */
@@ -0,0 +1,319 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file water_regions.cpp Handles dividing the water in the map into square regions to assist pathfinding. */
+
+#include "../stdafx.h"
+#include "../map_func.h"
+#include "../tile_cmd.h"
+#include "../track_func.h"
+#include "../bridge_map.h"
+#include "../tunnelbridge_map.h"
+#include "water_regions.h"
+
+#include <array>
+
+#include "../safeguards.h"
+
+/**
+ * The connected patches of water within one water region, and how they
+ * connect to the neighbouring water regions.
+ */
+struct WaterRegion {
+	bool dirty;                                                               ///< The map changed since the patches were determined.
+	uint dirty_index;                                                         ///< Position of the region in #_dirty_water_regions while it is dirty.
+	uint8 number_of_patches;                                                  ///< Number of connected patches of water in the region.
+	std::array<uint16, DIAGDIR_END> edge_traversability;                      ///< Per side of the region, bit \c i is set when a ship can leave the region through the \c i-th tile of that side.
+	std::array<WaterRegionPatchLabel, WATER_REGION_NUMBER_OF_TILES> labels;   ///< Patch label of every tile in the region.
+	std::vector<std::pair<TileIndex, TileIndex>> aqueducts;                   ///< Aqueduct ramps in the region with their other end in another region.
+
+	WaterRegion() : dirty(true), dirty_index(0), number_of_patches(0), edge_traversability{}, labels{} {}
+};
+
+static std::vector<WaterRegion> _water_regions;   ///< All water regions of the map, row by row.
+static std::vector<uint> _dirty_water_regions;    ///< Indices of the water regions that are dirty.
+
+static inline uint GetWaterRegionMapSizeX() { return MapSizeX() / WATER_REGION_EDGE_LENGTH; }
+static inline uint GetWaterRegionMapSizeY() { return MapSizeY() / WATER_REGION_EDGE_LENGTH; }
+
+static inline uint GetWaterRegionIndex(uint region_x, uint region_y)
+{
+	return region_y * GetWaterRegionMapSizeX() + region_x;
+}
+
+static inline uint GetLocalIndex(uint local_x, uint local_y)
+{
+	return local_y * WATER_REGION_EDGE_LENGTH + local_x;
+}
+
+/**
+ * Get the tile on a side of a water region.
+ * @param region_x X coordinate of the water region.
+ * @param region_y Y coordinate of the water region.
+ * @param side Side of the region.
+ * @param i Index of the tile along the side.
+ * @return The tile.
+ */
+static TileIndex GetEdgeTile(uint region_x, uint region_y, DiagDirection side, uint i)
+{
+	uint x = region_x * WATER_REGION_EDGE_LENGTH;
+	uint y = region_y * WATER_REGION_EDGE_LENGTH;
+	switch (side) {
+		case DIAGDIR_NE: return TileXY(x, y + i);
+		case DIAGDIR_SW: return TileXY(x + WATER_REGION_EDGE_LENGTH - 1, y + i);
+		case DIAGDIR_NW: return TileXY(x + i, y);
+		case DIAGDIR_SE: return TileXY(x + i, y + WATER_REGION_EDGE_LENGTH - 1);
+		default: NOT_REACHED();
+	}
+}
+
+static inline bool IsAqueductRamp(TileIndex tile)
+{
+	return IsBridgeTile(tile) && GetTunnelBridgeTransportType(tile) == TRANSPORT_WATER;
+}
+
+static inline TrackBits GetWaterTracks(TileIndex tile)
+{
+	return TrackStatusToTrackBits(GetTileTrackStatus(tile, TRANSPORT_WATER, 0));
+}
+
+/**
+ * Check whether a ship can pass the given side of a tile. Aqueduct ramps
+ * can't be left towards their bridge, a ship on them continues at the other end.
+ * @param tile The tile.
+ * @param side The side of the tile.
+ * @return True if the tile has a water track leading to the side.
+ */
+static bool IsWaterTileSideTraversable(TileIndex tile, DiagDirection side)
+{
+	if (IsAqueductRamp(tile) && GetTunnelBridgeDirection(tile) == side) return false;
+	return (GetWaterTracks(tile) & DiagdirReachesTracks(ReverseDiagDir(side))) != TRACK_BIT_NONE;
+}
+
+/**
+ * Determine the connected patches of water within a water region by flood
+ * filling it, and the sides of the region ships can leave it through.
+ * @param region The water region.
+ * @param region_x X coordinate of the water region.
+ * @param region_y Y coordinate of the water region.
+ */
+static void UpdateWaterRegion(WaterRegion &region, uint region_x, uint region_y)
+{
+	const uint min_x = region_x * WATER_REGION_EDGE_LENGTH;
+	const uint min_y = region_y * WATER_REGION_EDGE_LENGTH;
+
+	region.dirty = false;
+	region.number_of_patches = 0;
+	region.edge_traversability.fill(0);
+	region.labels.fill(INVALID_WATER_REGION_PATCH);
+	region.aqueducts.clear();
+
+	std::vector<TileIndex> todo;
+	for (uint start_y = 0; start_y < WATER_REGION_EDGE_LENGTH; start_y++) {
+		for (uint start_x = 0; start_x < WATER_REGION_EDGE_LENGTH; start_x++) {
+			if (region.labels[GetLocalIndex(start_x, start_y)] != INVALID_WATER_REGION_PATCH) continue;
+
+			TileIndex start = TileXY(min_x + start_x, min_y + start_y);
+			if (GetWaterTracks(start) == TRACK_BIT_NONE) continue;
+
+			/* A region has at most half of its tiles as separate patches, so the labels don't run out. */
+			const WaterRegionPatchLabel label = ++region.number_of_patches;
+			region.labels[GetLocalIndex(start_x, start_y)] = label;
+			todo.push_back(start);
+
+			while (!todo.empty()) {
+				TileIndex tile = todo.back();
+				todo.pop_back();
+
+				if (IsAqueductRamp(tile)) {
+					TileIndex other_end = GetOtherBridgeEnd(tile);
+					uint local_x = TileX(other_end) - min_x;
+					uint local_y = TileY(other_end) - min_y;
+					if (local_x < WATER_REGION_EDGE_LENGTH && local_y < WATER_REGION_EDGE_LENGTH) {
+						WaterRegionPatchLabel &other_label = region.labels[GetLocalIndex(local_x, local_y)];
+						if (other_label == INVALID_WATER_REGION_PATCH) {
+							other_label = label;
+							todo.push_back(other_end);
+						}
+					} else {
+						region.aqueducts.emplace_back(tile, other_end);
+					}
+				}
+
+				for (DiagDirection side = DIAGDIR_BEGIN; side < DIAGDIR_END; side++) {
+					if (!IsWaterTileSideTraversable(tile, side)) continue;
+
+					TileIndexDiffC offset = TileIndexDiffCByDiagDir(side);
+					uint local_x = TileX(tile) - min_x;
+					uint local_y = TileY(tile) - min_y;
+					uint next_x = local_x + offset.x;
+					uint next_y = local_y + offset.y;
+					if (next_x >= WATER_REGION_EDGE_LENGTH || next_y >= WATER_REGION_EDGE_LENGTH) {
+						/* The tile is on the side of the region; neighbouring regions are checked when visiting them. */
+						SetBit(region.edge_traversability[side], DiagDirToAxis(side) == AXIS_X ? local_y : local_x);
+						continue;
+					}
+
+					WaterRegionPatchLabel &next_label = region.labels[GetLocalIndex(next_x, next_y)];
+					if (next_label != INVALID_WATER_REGION_PATCH) continue;
+
+					TileIndex next = TileXY(min_x + next_x, min_y + next_y);
+					if (!IsWaterTileSideTraversable(next, ReverseDiagDir(side))) continue;
+
+					next_label = label;
+					todo.push_back(next);
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Get a water region, determining its patches if the map changed since.
+ * @param region_x X coordinate of the water region.
+ * @param region_y Y coordinate of the water region.
+ * @return The up to date water region.
+ * @note Ships plan their paths in parallel, see \c PlanVehicleTicks, so
+ *       #UpdateWaterRegions must have been called before.
+ */
+static const WaterRegion &GetUpdatedWaterRegion(uint region_x, uint region_y)
+{
+	WaterRegion &region = _water_regions[GetWaterRegionIndex(region_x, region_y)];
+	if (region.dirty) {
+		/* Take the region out of the dirty list by moving the last one in its place. */
+		uint last = _dirty_water_regions.back();
+		_dirty_water_regions[region.dirty_index] = last;
+		_water_regions[last].dirty_index = region.dirty_index;
+		_dirty_water_regions.pop_back();
+
+		UpdateWaterRegion(region, region_x, region_y);
+	}
+	return region;
+}
+
+/**
+ * Get a unique key of a water region patch, e.g. for hashing.
+ * @param patch The water region patch.
+ * @return The key.
+ */
+uint32 GetWaterRegionPatchKey(const WaterRegionPatchDesc &patch)
+{
+	return GetWaterRegionIndex(patch.x, patch.y) << 8 | patch.label;
+}
+
+/**
+ * Get the tile in the middle of the water region of a patch.
+ * @param patch The water region patch.
+ * @return The center tile; it need not be part of the patch.
+ */
+TileIndex GetWaterRegionCenterTile(const WaterRegionPatchDesc &patch)
+{
+	return TileXY(patch.x * WATER_REGION_EDGE_LENGTH + WATER_REGION_EDGE_LENGTH / 2, patch.y * WATER_REGION_EDGE_LENGTH + WATER_REGION_EDGE_LENGTH / 2);
+}
+
+/**
+ * Get the water region patch a tile is part of.
+ * @param tile The tile.
+ * @return The patch; its label is #INVALID_WATER_REGION_PATCH when ships can't use the tile.
+ */
+WaterRegionPatchDesc GetWaterRegionPatchInfo(TileIndex tile)
+{
+	uint region_x = TileX(tile) / WATER_REGION_EDGE_LENGTH;
+	uint region_y = TileY(tile) / WATER_REGION_EDGE_LENGTH;
+	const WaterRegion &region = GetUpdatedWaterRegion(region_x, region_y);
+	return { region_x, region_y, region.labels[GetLocalIndex(TileX(tile) % WATER_REGION_EDGE_LENGTH, TileY(tile) % WATER_REGION_EDGE_LENGTH)] };
+}
+
+/**
+ * Call a function for every patch a ship can reach directly from the given
+ * patch, i.e. the patches next to it in the neighbouring regions and the ones
+ * at the other end of its aqueducts. Each neighbour is visited once, in an
+ * order that only depends on the map.
+ * @param patch The water region patch.
+ * @param callback The function to call.
+ */
+void VisitWaterRegionPatchNeighbours(const WaterRegionPatchDesc &patch, const VisitWaterRegionPatchCallback &callback)
+{
+	const WaterRegion &region = GetUpdatedWaterRegion(patch.x, patch.y);
+	std::vector<WaterRegionPatchDesc> visited;
+
+	auto visit = [&](const WaterRegionPatchDesc &neighbour) {
+		if (std::find(visited.begin(), visited.end(), neighbour) != visited.end()) return;
+		visited.push_back(neighbour);
+		callback(neighbour);
+	};
+
+	for (DiagDirection side = DIAGDIR_BEGIN; side < DIAGDIR_END; side++) {
+		if (region.edge_traversability[side] == 0) continue;
+
+		TileIndexDiffC offset = TileIndexDiffCByDiagDir(side);
+		uint neighbour_x = patch.x + offset.x;
+		uint neighbour_y = patch.y + offset.y;
+		if (neighbour_x >= GetWaterRegionMapSizeX() || neighbour_y >= GetWaterRegionMapSizeY()) continue;
+
+		const WaterRegion &neighbour = GetUpdatedWaterRegion(neighbour_x, neighbour_y);
+		uint traversable = region.edge_traversability[side] & neighbour.edge_traversability[ReverseDiagDir(side)];
+		for (uint i = 0; i < WATER_REGION_EDGE_LENGTH; i++) {
+			if (!HasBit(traversable, i)) continue;
+
+			TileIndex tile = GetEdgeTile(patch.x, patch.y, side, i);
+			if (region.labels[GetLocalIndex(TileX(tile) % WATER_REGION_EDGE_LENGTH, TileY(tile) % WATER_REGION_EDGE_LENGTH)] != patch.label) continue;
+
+			TileIndex neighbour_tile = GetEdgeTile(neighbour_x, neighbour_y, ReverseDiagDir(side), i);
+			visit({ neighbour_x, neighbour_y, neighbour.labels[GetLocalIndex(TileX(neighbour_tile) % WATER_REGION_EDGE_LENGTH, TileY(neighbour_tile) % WATER_REGION_EDGE_LENGTH)] });
+		}
+	}
+
+	for (const auto &aqueduct : region.aqueducts) {
+		if (region.labels[GetLocalIndex(TileX(aqueduct.first) % WATER_REGION_EDGE_LENGTH, TileY(aqueduct.first) % WATER_REGION_EDGE_LENGTH)] != patch.label) continue;
+		visit(GetWaterRegionPatchInfo(aqueduct.second));
+	}
+}
+
+/**
+ * Mark the water region of a tile to be determined again.
+ * @param tile The tile that changed.
+ */
+void InvalidateWaterRegion(TileIndex tile)
+{
+	if (_water_regions.empty()) return;
+
+	uint index = GetWaterRegionIndex(TileX(tile) / WATER_REGION_EDGE_LENGTH, TileY(tile) / WATER_REGION_EDGE_LENGTH);
+	if (_water_regions[index].dirty) return;
+
+	_water_regions[index].dirty = true;
+	_water_regions[index].dirty_index = (uint)_dirty_water_regions.size();
+	_dirty_water_regions.push_back(index);
+}
+
+/**
+ * Determine the patches of all water regions that were invalidated. The
+ * result does not depend on when this happens, it only makes sure no region
+ * has to be updated while ships look up regions in parallel.
+ */
+void UpdateWaterRegions()
+{
+	const uint size_x = GetWaterRegionMapSizeX();
+	for (uint index : _dirty_water_regions) {
+		WaterRegion &region = _water_regions[index];
+		if (region.dirty) UpdateWaterRegion(region, index % size_x, index / size_x);
+	}
+	_dirty_water_regions.clear();
+}
+
+/** Allocate the water regions for the current map size; they start out dirty. */
+void AllocateWaterRegions()
+{
+	const uint count = GetWaterRegionMapSizeX() * GetWaterRegionMapSizeY();
+	_water_regions.clear();
+	_water_regions.resize(count);
+	_dirty_water_regions.resize(count);
+	for (uint i = 0; i < count; i++) {
+		_dirty_water_regions[i] = i;
+		_water_regions[i].dirty_index = i;
+	}
+}
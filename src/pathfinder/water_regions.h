@@ -0,0 +1,46 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file water_regions.h Handles dividing the water in the map into square regions to assist pathfinding. */
+
+#ifndef WATER_REGIONS_H
+#define WATER_REGIONS_H
+
+#include "../tile_type.h"
+#include <functional>
+
+typedef uint8 WaterRegionPatchLabel; ///< Label of a connected patch of water within a water region.
+
+static const uint WATER_REGION_EDGE_LENGTH = 16; ///< Number of tiles along the sides of a water region.
+static const uint WATER_REGION_NUMBER_OF_TILES = WATER_REGION_EDGE_LENGTH * WATER_REGION_EDGE_LENGTH; ///< Number of tiles in a water region.
+static const WaterRegionPatchLabel INVALID_WATER_REGION_PATCH = 0; ///< Label of the tiles ships can't use.
+
+/**
+ * A connected patch of water within a water region. Ships can move between
+ * any two tiles of a patch without leaving the water region.
+ */
+struct WaterRegionPatchDesc {
+	uint x;                      ///< X coordinate of the water region, in water regions.
+	uint y;                      ///< Y coordinate of the water region, in water regions.
+	WaterRegionPatchLabel label; ///< Label of the patch within the water region.
+
+	bool operator==(const WaterRegionPatchDesc &other) const { return this->x == other.x && this->y == other.y && this->label == other.label; }
+	bool operator!=(const WaterRegionPatchDesc &other) const { return !(*this == other); }
+};
+
+/** Function called for every neighbouring patch of a water region patch. */
+typedef std::function<void(const WaterRegionPatchDesc &)> VisitWaterRegionPatchCallback;
+
+uint32 GetWaterRegionPatchKey(const WaterRegionPatchDesc &patch);
+TileIndex GetWaterRegionCenterTile(const WaterRegionPatchDesc &patch);
+WaterRegionPatchDesc GetWaterRegionPatchInfo(TileIndex tile);
+void VisitWaterRegionPatchNeighbours(const WaterRegionPatchDesc &patch, const VisitWaterRegionPatchCallback &callback);
+
+void UpdateWaterRegions();
+void AllocateWaterRegions();
+
+#endif /* WATER_REGIONS_H */
@@ -10,42 +10,190 @@
 #ifndef NODELIST_HPP
 #define NODELIST_HPP
 
-#include "../../misc/array.hpp"
+#include "../../core/math_func.hpp"
 #include "../../misc/hashtable.hpp"
 #include "../../misc/binaryheap.hpp"
+#include "../../string_func.h"
+
+#include <atomic>
+#include <type_traits>
+
+/**
+ * Array of nodes, allocated in blocks so the nodes never move. When the
+ *  array is reset the blocks are kept, so the next search on the same
+ *  thread does not have to allocate them again.
+ */
+template <class Titem_, uint Tblock_size_ = 1024>
+class CNodeArrayT {
+	static_assert(std::is_trivially_destructible<Titem_>::value, "nodes are forgotten without destructing them");
+
+protected:
+	std::vector<Titem_ *> m_blocks; ///< blocks of Tblock_size_ (unconstructed) items
+	uint m_count = 0;               ///< number of items in use
+
+public:
+	/** destructor, frees all blocks */
+	~CNodeArrayT()
+	{
+		for (Titem_ *block : m_blocks) free(block);
+	}
+
+	/** Forget all items, in constant time. */
+	inline void Reset()
+	{
+		m_count = 0;
+	}
+
+	/**
+	 * Free the blocks not needed for the given number of items.
+	 * @param max_items Number of items to keep room for.
+	 */
+	inline void Trim(uint max_items)
+	{
+		size_t blocks = CeilDiv(std::max(max_items, m_count), Tblock_size_);
+		while (m_blocks.size() > blocks) {
+			free(m_blocks.back());
+			m_blocks.pop_back();
+		}
+	}
+
+	/** Return actual number of items */
+	inline uint Length() const
+	{
+		return m_count;
+	}
+
+	/** Return number of items there is room for without allocating */
+	inline size_t Capacity() const
+	{
+		return m_blocks.size() * Tblock_size_;
+	}
+
+	/** allocate and construct new item */
+	inline Titem_ *AppendC()
+	{
+		if (m_count == Capacity()) m_blocks.push_back(MallocT<Titem_>(Tblock_size_));
+		Titem_ *item = &m_blocks[m_count / Tblock_size_][m_count % Tblock_size_];
+		m_count++;
+		return new (item) Titem_();
+	}
+
+	/** indexed access (non-const) */
+	inline Titem_& operator[](uint index)
+	{
+		return m_blocks[index / Tblock_size_][index % Tblock_size_];
+	}
+
+	/** indexed access (const) */
+	inline const Titem_& operator[](uint index) const
+	{
+		return m_blocks[index / Tblock_size_][index % Tblock_size_];
+	}
+
+	/**
+	 * Helper for creating a human readable output of this data.
+	 * @param dmp The location to dump to.
+	 */
+	template <typename D> void Dump(D &dmp) const
+	{
+		dmp.WriteValue("capacity", Capacity());
+		uint num_items = Length();
+		dmp.WriteValue("num_items", num_items);
+		for (uint i = 0; i < num_items; i++) {
+			const Titem_ &item = (*this)[i];
+			char name[32];
+			seprintf(name, lastof(name), "item[%d]", i);
+			dmp.WriteStructT(name, &item);
+		}
+	}
+};
+
+/** Statistics of the node pools of all node lists. */
+struct CNodeListStats {
+	static inline std::atomic<uint64> s_searches{0};   ///< Number of node lists taken from a pool.
+	static inline std::atomic<uint64> s_pools{0};      ///< Number of pools allocated, one per thread and node list type in use at the same time.
+	static inline std::atomic<uint64> s_peak_nodes{0}; ///< Highest number of nodes used by one node list.
+
+	/** Record the number of nodes used by a node list. */
+	static void AddNodes(uint64 nodes)
+	{
+		uint64 peak = s_peak_nodes.load(std::memory_order_relaxed);
+		while (nodes > peak && !s_peak_nodes.compare_exchange_weak(peak, nodes, std::memory_order_relaxed)) {}
+	}
+};
 
 /**
  * Hash table based node list multi-container class.
  *  Implements open list, closed list and priority queue for A-star
  *  path finder.
+ *  The containers come from a pool per thread, and are emptied in
+ *  constant time and returned to the pool when the node list is
+ *  destroyed, so searches do not allocate memory once the pool is
+ *  large enough for them.
  */
 template <class Titem_, int Thash_bits_open_, int Thash_bits_closed_>
 class CNodeList_HashTableT {
 public:
 	typedef Titem_ Titem;                                        ///< Make #Titem_ visible from outside of class.
 	typedef typename Titem_::Key Key;                            ///< Make Titem_::Key a property of this class.
-	typedef SmallArray<Titem_, 65536, 256> CItemArray;           ///< Type that we will use as item container.
+	typedef CNodeArrayT<Titem_> CItemArray;                      ///< Type that we will use as item container.
 	typedef CHashTableT<Titem_, Thash_bits_open_  > COpenList;   ///< How pointers to open nodes will be stored.
 	typedef CHashTableT<Titem_, Thash_bits_closed_> CClosedList; ///< How pointers to closed nodes will be stored.
 	typedef CBinaryHeapT<Titem_> CPriorityQueue;                 ///< How the priority queue will be managed.
 
+	static const uint MAX_POOLED_NODES = 65536; ///< Pools keep room for at most this many nodes between searches.
+
 protected:
-	CItemArray      m_arr;        ///< Here we store full item data (Titem_).
-	COpenList       m_open;       ///< Hash table of pointers to open item data.
-	CClosedList     m_closed;     ///< Hash table of pointers to closed item data.
-	CPriorityQueue  m_open_queue; ///< Priority queue of pointers to open item data.
+	/** The containers of a node list, kept in a pool between searches. */
+	struct Pool {
+		CItemArray      m_arr;
+		COpenList       m_open;
+		CClosedList     m_closed;
+		CPriorityQueue  m_open_queue;
+
+		Pool() : m_open_queue(2048) {}
+	};
+
+	/** Pools not in use by a node list of this thread. */
+	static inline thread_local std::vector<std::unique_ptr<Pool>> s_free_pools;
+
+	std::unique_ptr<Pool> m_pool; ///< Containers of this node list.
+	CItemArray      &m_arr;       ///< Here we store full item data (Titem_).
+	COpenList       &m_open;      ///< Hash table of pointers to open item data.
+	CClosedList     &m_closed;    ///< Hash table of pointers to closed item data.
+	CPriorityQueue  &m_open_queue; ///< Priority queue of pointers to open item data.
 	Titem          *m_new_node;   ///< New open node under construction.
 
+	/** Take containers from the pool of this thread, or allocate new ones. */
+	static std::unique_ptr<Pool> AcquirePool()
+	{
+		CNodeListStats::s_searches++;
+		if (s_free_pools.empty()) {
+			CNodeListStats::s_pools++;
+			return std::make_unique<Pool>();
+		}
+		std::unique_ptr<Pool> pool = std::move(s_free_pools.back());
+		s_free_pools.pop_back();
+		return pool;
+	}
+
 public:
 	/** default constructor */
-	CNodeList_HashTableT() : m_open_queue(2048)
+	CNodeList_HashTableT() : m_pool(AcquirePool()), m_arr(m_pool->m_arr), m_open(m_pool->m_open), m_closed(m_pool->m_closed), m_open_queue(m_pool->m_open_queue)
 	{
 		m_new_node = nullptr;
 	}
 
-	/** destructor */
+	/** destructor, empties the containers and returns them to the pool */
 	~CNodeList_HashTableT()
 	{
+		CNodeListStats::AddNodes(m_arr.Length());
+		m_arr.Reset();
+		m_arr.Trim(MAX_POOLED_NODES);
+		m_open.Reset();
+		m_closed.Reset();
+		m_open_queue.Clear();
+		s_free_pools.push_back(std::move(m_pool));
 	}
 
 	/** return number of open nodes */
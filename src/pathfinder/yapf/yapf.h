@@ -24,9 +24,17 @@
  * @param enterdir diagonal direction which the ship will enter this new tile from
  * @param tracks   available tracks on the new tile (to choose from)
  * @param path_found [out] Whether a path has been found (true) or has been guessed (false)
+ * @param docking  [out] if not nullptr, the docking tiles whose occupancy was taken into account
  * @return         the best trackdir for next turn or INVALID_TRACK if the path could not be found
  */
-Track YapfShipChooseTrack(const Ship *v, TileIndex tile, DiagDirection enterdir, TrackBits tracks, bool &path_found, ShipPathCache &path_cache);
+Track YapfShipChooseTrack(const Ship *v, TileIndex tile, DiagDirection enterdir, TrackBits tracks, bool &path_found, ShipPathCache &path_cache, ShipDockingOccupancy *docking = nullptr);
+
+/**
+ * Check whether the occupancy of docking tiles, as recorded by #YapfShipChooseTrack, is still the same.
+ * @param docking the docking tiles and their occupancy
+ * @return true if no ship entered or left any of the docking tiles
+ */
+bool YapfShipDockingOccupancyUnchanged(const ShipDockingOccupancy &docking);
 
 /**
  * Returns true if it is better to reverse the ship before leaving depot using YAPF.
@@ -43,9 +51,23 @@ bool YapfShipCheckReverse(const Ship *v, Trackdir *trackdir);
  * @param enterdir  diagonal direction which the RV will enter this new tile from
  * @param trackdirs available trackdirs on the new tile (to choose from)
  * @param path_found [out] Whether a path has been found (true) or has been guessed (false)
+ * @param occupancy [out] if not nullptr, the road stops whose occupancy was taken into account; the caches are then not updated, see #YapfRoadUpdateCaches
  * @return          the best trackdir for next turn or INVALID_TRACKDIR if the path could not be found
  */
-Trackdir YapfRoadVehicleChooseTrack(const RoadVehicle *v, TileIndex tile, DiagDirection enterdir, TrackdirBits trackdirs, bool &path_found, RoadVehPathCache &path_cache);
+Trackdir YapfRoadVehicleChooseTrack(const RoadVehicle *v, TileIndex tile, DiagDirection enterdir, TrackdirBits trackdirs, bool &path_found, RoadVehPathCache &path_cache, RoadVehStopOccupancy *occupancy = nullptr);
+
+/**
+ * Check whether the occupancy of road stops, as recorded by #YapfRoadVehicleChooseTrack, is still the same.
+ * @param occupancy the road stops and their occupancy cost
+ * @return true if no road vehicle entered or left any of the road stops in a way that changes the costs
+ */
+bool YapfRoadStopOccupancyUnchanged(const RoadVehStopOccupancy &occupancy);
+
+/**
+ * Process the road layout changes into the caches of the road vehicle
+ * pathfinder, so searches running concurrently can read the caches.
+ */
+void YapfRoadUpdateCaches();
 
 /**
  * Finds the best path for given train using YAPF.
@@ -301,6 +301,12 @@ public:
 		return m_veh;
 	}
 
+	/** Set the vehicle without searching, for following a path found before. */
+	inline void SetVehicle(const VehicleType *v)
+	{
+		m_veh = v;
+	}
+
 	void DumpBase(DumpTarget &dmp) const
 	{
 		dmp.WriteStructT("m_nodes", &m_nodes);
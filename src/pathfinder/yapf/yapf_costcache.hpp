@@ -11,6 +11,8 @@
 #define YAPF_COSTCACHE_HPP
 
 #include "../../date_func.h"
+#include <unordered_map>
+#include <vector>
 
 /**
  * CYapfSegmentCostCacheNoneT - the formal only yapf cost cache provider that implements
@@ -91,19 +93,53 @@ public:
 
 
 /**
- * Base class for segment cost cache providers. Contains global counter
- *  of track layout changes and static notification function called whenever
- *  the track layout changes. It is implemented as base class because it needs
- *  to be shared between all rail YAPF types (one shared counter, one notification
- *  function.
+ * Base class for segment cost cache providers. Contains the global log of
+ *  track and road layout changes and static notification functions called
+ *  whenever the layout changes. It is implemented as base class because it
+ *  needs to be shared between all rail and road YAPF types (one shared log,
+ *  one notification function).
  */
 struct CSegmentCostCacheBase
 {
-	static int   s_rail_change_counter;
+	static const size_t MAX_CHANGED_TILES = 1 << 16; ///< Maximum length of the change log; older entries are dropped.
+
+	static int   s_rail_change_counter;              ///< Incremented on every track layout or reservation change.
+	static std::vector<TileIndex> s_changed_tiles;   ///< Log of tiles with a changed track or road layout, #INVALID_TILE when everything changed.
+	static uint64 s_changed_tiles_offset;            ///< Number of entries dropped from the front of #s_changed_tiles.
+
+	static uint64 s_hits;        ///< Number of segments found in a global rail cache.
+	static uint64 s_misses;      ///< Number of segments that had to be calculated for a global rail cache.
+	static uint64 s_road_hits;   ///< Number of segments found in the road cache.
+	static uint64 s_road_misses; ///< Number of segments that had to be walked while the road cache could be used.
+	static uint64 s_evictions;   ///< Number of segments evicted because a tile they cover changed.
+	static uint64 s_flushes;     ///< Number of times a global cache was emptied completely.
 
 	static void NotifyTrackLayoutChange(TileIndex tile, Track track)
 	{
 		s_rail_change_counter++;
+		NotifyTileChange(tile);
+	}
+
+	/** Log a changed tile without invalidating the caches that depend on reservations. */
+	static void NotifyTileChange(TileIndex tile)
+	{
+		if (s_changed_tiles.size() >= MAX_CHANGED_TILES) {
+			/* Caches that did not look at the oldest half will have to flush completely. */
+			s_changed_tiles.erase(s_changed_tiles.begin(), s_changed_tiles.begin() + MAX_CHANGED_TILES / 2);
+			s_changed_tiles_offset += MAX_CHANGED_TILES / 2;
+		}
+		s_changed_tiles.push_back(tile);
+	}
+
+	static void NotifyReservationChange()
+	{
+		s_rail_change_counter++;
+	}
+
+	/** Get the number of track and road layout changes so far. */
+	static uint64 GetLayoutGeneration()
+	{
+		return s_changed_tiles_offset + s_changed_tiles.size();
 	}
 };
 
@@ -116,7 +152,9 @@ struct CSegmentCostCacheBase
  *  be always the same (TileIndex + DiagDirection) that represent the beginning
  *  of the segment (origin tile and exit-dir from this tile).
  *  Different CYapfCachedCostT types can share the same type of CSegmentCostCacheT.
- *  Look at CYapfRailSegment (yapf_node_rail.hpp) for the segment example
+ *  Look at CYapfRailSegment (yapf_node_rail.hpp) for the segment example.
+ *  Segments are also indexed by the tiles their cost depends on, so a change
+ *  of the track layout only evicts the segments covering the changed tile.
  */
 template <class Tsegment>
 struct CSegmentCostCacheT : public CSegmentCostCacheBase {
@@ -125,17 +163,24 @@ struct CSegmentCostCacheT : public CSegmentCostCacheBase {
 	typedef CHashTableT<Tsegment, C_HASH_BITS> HashTable;
 	typedef SmallArray<Tsegment> Heap;
 	typedef typename Tsegment::Key Key;    ///< key to hash table
+	typedef std::unordered_map<uint32, std::vector<Tsegment *>> TileSegments; ///< Keyed by the tile index.
 
 	HashTable    m_map;
 	Heap         m_heap;
+	TileSegments m_tile_segments; ///< Segments per tile they depend on; may still list evicted segments.
+	uint64       m_changes_seen;  ///< Number of entries of the change log already processed.
+	uint         m_num_evicted;   ///< Number of segments in #m_heap that are no longer in #m_map.
 
-	inline CSegmentCostCacheT() {}
+	inline CSegmentCostCacheT() : m_changes_seen(s_changed_tiles_offset + s_changed_tiles.size()), m_num_evicted(0) {}
 
 	/** flush (clear) the cache */
 	inline void Flush()
 	{
 		m_map.Clear();
 		m_heap.Clear();
+		m_tile_segments.clear();
+		m_num_evicted = 0;
+		s_flushes++;
 	}
 
 	inline Tsegment& Get(Key &key, bool *found)
@@ -150,6 +195,57 @@ struct CSegmentCostCacheT : public CSegmentCostCacheBase {
 		}
 		return *item;
 	}
+
+	/**
+	 * Register the tiles the cost of a segment depends on.
+	 * @param segment The segment in this cache.
+	 * @param tiles The tiles, possibly with duplicates.
+	 */
+	inline void SetTiles(Tsegment &segment, const std::vector<TileIndex> &tiles)
+	{
+		for (TileIndex tile : tiles) m_tile_segments[static_cast<uint32>(tile)].push_back(&segment);
+	}
+
+	/**
+	 * Evict all segments that depend on the given tile.
+	 * @param tile The changed tile.
+	 */
+	inline void InvalidateTile(TileIndex tile)
+	{
+		auto it = m_tile_segments.find(static_cast<uint32>(tile));
+		if (it == m_tile_segments.end()) return;
+
+		for (Tsegment *segment : it->second) {
+			/* Segments that were evicted before are not in the map anymore. */
+			if (m_map.TryPop(*segment)) {
+				m_num_evicted++;
+				s_evictions++;
+			}
+		}
+		m_tile_segments.erase(it);
+	}
+
+	/** Process the track layout changes made since the last call. */
+	inline void ProcessChanges()
+	{
+		uint64 changes_end = s_changed_tiles_offset + s_changed_tiles.size();
+		if (m_changes_seen < s_changed_tiles_offset) {
+			/* Some of the changes were dropped from the log already. */
+			Flush();
+		} else {
+			for (size_t i = m_changes_seen - s_changed_tiles_offset; i < s_changed_tiles.size(); i++) {
+				if (s_changed_tiles[i] == INVALID_TILE) {
+					Flush();
+				} else {
+					InvalidateTile(s_changed_tiles[i]);
+				}
+			}
+		}
+		m_changes_seen = changes_end;
+
+		/* Evicted segments keep their storage; start afresh once that is the bulk of it. */
+		if (m_num_evicted > 1024 && m_num_evicted > m_heap.Length() / 2) Flush();
+	}
 };
 
 /**
@@ -182,13 +278,26 @@ protected:
 	inline static Cache& stGetGlobalCache()
 	{
 		static int last_rail_change_counter = 0;
+		static YAPFSettings last_settings = {};
 		static Cache C;
 
-		/* delete the cache sometimes... */
-		if (last_rail_change_counter != Cache::s_rail_change_counter) {
-			last_rail_change_counter = Cache::s_rail_change_counter;
+		/* The segment costs include the penalties from the settings. */
+		if (memcmp(&last_settings, &_settings_game.pf.yapf, sizeof(YAPFSettings)) != 0) {
+			memcpy(&last_settings, &_settings_game.pf.yapf, sizeof(YAPFSettings));
 			C.Flush();
 		}
+
+		if (Types::TrackFollower::DoTrackMasking()) {
+			/* The follower masks reserved tracks, so the segments also depend on
+			 * the reservations, which are not logged per tile. Delete the cache
+			 * on every change. */
+			if (last_rail_change_counter != Cache::s_rail_change_counter) {
+				last_rail_change_counter = Cache::s_rail_change_counter;
+				C.Flush();
+			}
+		} else {
+			C.ProcessChanges();
+		}
 		return C;
 	}
 
@@ -206,9 +315,25 @@ public:
 		bool found;
 		CachedData &item = m_global_cache.Get(key, &found);
 		Yapf().ConnectNodeToCachedData(n, item);
+		if (found) {
+			Cache::s_hits++;
+		} else {
+			Cache::s_misses++;
+		}
 		return found;
 	}
 
+	/**
+	 * Called by the cost calculation when it calculated the segment of a node,
+	 *  with the tiles the segment cost depends on.
+	 */
+	inline void PfNodeCacheSetTiles(Node &n, const std::vector<TileIndex> &tiles)
+	{
+		/* Caches of followers that mask reservations are deleted on every change anyway. */
+		if (Types::TrackFollower::DoTrackMasking()) return;
+		if (Yapf().CanUseGlobalCache(n)) m_global_cache.SetTiles(*n.m_segment, tiles);
+	}
+
 	/**
 	 * Called by YAPF to flush the cached segment cost data back into cache storage.
 	 *  Current cache implementation doesn't use that.
@@ -218,4 +343,78 @@ public:
 	}
 };
 
+/** Counters shared by the caches of depot searches of all vehicle types. */
+struct CDepotSearchCacheBase
+{
+	static uint64 s_hits;        ///< Number of depot searches answered from a cache.
+	static uint64 s_misses;      ///< Number of depot searches without a result in a cache.
+	static uint64 s_invalidated; ///< Number of results dropped as the state they depended on changed.
+};
+
+/**
+ * Results of searches for the nearest depot, made when vehicles check whether
+ * they need servicing. A result is found by the key of the search, i.e. the
+ * origin and everything of the vehicle the search depends on. It is only
+ * reused when the state the search looked at, which is logged as a Tstate,
+ * did not change; the caller checks that. The cache only holds results of
+ * the current track and road layout and settings.
+ */
+template <class Tkey, class Tstate>
+struct CDepotSearchCacheT : public CDepotSearchCacheBase
+{
+	static const size_t MAX_RESULTS = 4096; ///< The cache is emptied when it holds this many results.
+
+	/** Outcome of a search, and the state it depends on. */
+	struct Result {
+		FindDepotData m_depot;
+		Tstate        m_state;
+	};
+
+	typedef std::unordered_map<Tkey, Result, typename Tkey::Hash> Results;
+
+	Results      m_results;
+	uint64       m_layout_generation = 0; ///< #CSegmentCostCacheBase::GetLayoutGeneration of the results.
+	YAPFSettings m_settings = {};         ///< Pathfinder settings of the results.
+
+	/** Forget all results when the layout or the settings changed since they were found. */
+	inline void Update()
+	{
+		uint64 layout_generation = CSegmentCostCacheBase::GetLayoutGeneration();
+		if (m_layout_generation != layout_generation || memcmp(&m_settings, &_settings_game.pf.yapf, sizeof(YAPFSettings)) != 0) {
+			m_results.clear();
+			m_layout_generation = layout_generation;
+			memcpy(&m_settings, &_settings_game.pf.yapf, sizeof(YAPFSettings));
+		}
+	}
+
+	/**
+	 * Find the result of an earlier search.
+	 * @param key The key of the search.
+	 * @param is_unchanged Function telling whether the logged state is still the same.
+	 * @return The result, or nullptr if the search has to be made.
+	 */
+	template <class Tcheck>
+	inline const Result *Find(const Tkey &key, Tcheck is_unchanged)
+	{
+		typename Results::iterator it = m_results.find(key);
+		if (it == m_results.end()) {
+			s_misses++;
+			return nullptr;
+		}
+		if (!is_unchanged(it->second.m_state)) {
+			s_invalidated++;
+			m_results.erase(it);
+			return nullptr;
+		}
+		s_hits++;
+		return &it->second;
+	}
+
+	inline void Add(const Tkey &key, const FindDepotData &depot, Tstate &&state)
+	{
+		if (m_results.size() >= MAX_RESULTS) m_results.clear();
+		m_results[key] = {depot, std::move(state)};
+	}
+};
+
 #endif /* YAPF_COSTCACHE_HPP */
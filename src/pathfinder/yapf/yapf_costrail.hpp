@@ -57,6 +57,8 @@ protected:
 	int m_max_cost;
 	bool m_disable_cache;
 	std::vector<int> m_sig_look_ahead_costs;
+	std::vector<TileIndex> m_segment_tiles; ///< Tiles the cost of the segment being calculated depends on.
+	std::vector<CYapfRailStateEntry> *m_state_log = nullptr; ///< If not nullptr, log of the signal states and reservations looked at.
 
 public:
 	bool          m_stopped_on_first_two_way_signal;
@@ -157,6 +159,14 @@ public:
 		if (n.m_num_signals_passed >= m_sig_look_ahead_costs.size() / 2) return 0;
 		if (!IsPbsSignal(n.m_last_signal_type)) return 0;
 
+		int cost = ReservedTilesPenalty(tile, trackdir, skipped);
+		if (m_state_log != nullptr) m_state_log->push_back({tile, trackdir, skipped, cost});
+		return cost;
+	}
+
+	/** The penalty for the current reservation of the tiles, including skipped ones. */
+	inline int ReservedTilesPenalty(TileIndex tile, Trackdir trackdir, int skipped)
+	{
 		if (IsRailStationTile(tile) && IsAnyStationTileReserved(tile, trackdir, skipped)) {
 			return Yapf().PfGetSettings().rail_pbs_station_penalty * (skipped + 1);
 		} else if (TrackOverlapsTracks(GetReservedTrackbits(tile), TrackdirToTrack(trackdir))) {
@@ -181,6 +191,7 @@ public:
 				if (has_signal_along) {
 					SignalState sig_state = GetSignalStateByTrackdir(tile, trackdir);
 					SignalType sig_type = GetSignalType(tile, TrackdirToTrack(trackdir));
+					if (m_state_log != nullptr) m_state_log->push_back({tile, trackdir, -1, sig_state});
 
 					n.m_last_signal_type = sig_type;
 
@@ -256,12 +267,59 @@ public:
 		return cost;
 	}
 
+	/**
+	 * Remember the tiles a track follower looked at, as the segment cost depends on them.
+	 * @param tf The track follower after following a track.
+	 */
+	inline void AddSegmentTiles(const TrackFollower *tf)
+	{
+		m_segment_tiles.push_back(tf->m_old_tile);
+		if (tf->m_new_tile == tf->m_old_tile) return;
+
+		/* Skipped tunnel, bridge and platform tiles, and the tile behind the
+		 * platform, which determines where the platform ends. */
+		TileIndexDiff diff = TileOffsByDiagDir(tf->m_exitdir);
+		TileIndex tile = tf->m_old_tile;
+		for (int i = 0; i <= tf->m_tiles_skipped; i++) {
+			tile += diff;
+			m_segment_tiles.push_back(tile);
+		}
+		if (tf->m_is_station) m_segment_tiles.push_back(tile + diff);
+	}
+
 public:
 	inline void SetMaxCost(int max_cost)
 	{
 		m_max_cost = max_cost;
 	}
 
+	/**
+	 * Set where to log the signal states and reservations the costs depend on.
+	 * @param state_log The log, or nullptr to not log.
+	 */
+	inline void SetStateLog(std::vector<CYapfRailStateEntry> *state_log)
+	{
+		m_state_log = state_log;
+	}
+
+	/**
+	 * Check whether the signal states and reservations, as logged during a search, are still the same.
+	 * @param state_log The log.
+	 * @return True if a new search would see the same state.
+	 */
+	inline bool IsStateUnchanged(const std::vector<CYapfRailStateEntry> &state_log)
+	{
+		for (const CYapfRailStateEntry &entry : state_log) {
+			if (entry.m_skipped < 0) {
+				if (!IsTileType(entry.m_tile, MP_RAILWAY) || !HasSignalOnTrackdir(entry.m_tile, entry.m_td)) return false;
+				if (GetSignalStateByTrackdir(entry.m_tile, entry.m_td) != entry.m_value) return false;
+			} else {
+				if (ReservedTilesPenalty(entry.m_tile, entry.m_td, entry.m_skipped) != entry.m_value) return false;
+			}
+		}
+		return true;
+	}
+
 	/**
 	 * Called by YAPF to calculate the cost from the origin to the given node.
 	 *  Calculates only the cost of given node, adds it to the parent node cost
@@ -324,6 +382,11 @@ public:
 
 		TrackFollower tf_local(v, Yapf().GetCompatibleRailTypes());
 
+		/* The tiles are only needed when the segment is stored in the global cache. */
+		bool collect_tiles = !is_cached_segment && Yapf().CanUseGlobalCache(n);
+		m_segment_tiles.clear();
+		if (collect_tiles) AddSegmentTiles(tf);
+
 		if (!has_parent) {
 			/* We will jump to the middle of the cost calculator assuming that segment cache is not used. */
 			assert(!is_cached_segment);
@@ -353,6 +416,7 @@ public:
 					if (segment.m_last_signal_tile != INVALID_TILE) {
 						assert(HasSignalOnTrackdir(segment.m_last_signal_tile, segment.m_last_signal_td));
 						SignalState sig_state = GetSignalStateByTrackdir(segment.m_last_signal_tile, segment.m_last_signal_td);
+						if (m_state_log != nullptr) m_state_log->push_back({segment.m_last_signal_tile, segment.m_last_signal_td, -1, sig_state});
 						bool is_red = (sig_state == SIGNAL_STATE_RED);
 						n.flags_u.flags_s.m_last_signal_was_red = is_red;
 						if (is_red) {
@@ -482,7 +546,10 @@ no_entry_cost: // jump here at the beginning if the node has no parent (it is th
 			tf = &tf_local;
 			tf_local.Init(v, Yapf().GetCompatibleRailTypes());
 
-			if (!tf_local.Follow(cur.tile, cur.td)) {
+			bool followed = tf_local.Follow(cur.tile, cur.td);
+			if (collect_tiles) AddSegmentTiles(&tf_local);
+
+			if (!followed) {
 				assert(tf_local.m_err != TrackFollower::EC_NONE);
 				/* Can't move to the next tile (EOL?). */
 				if (tf_local.m_err == TrackFollower::EC_RAIL_ROAD_TYPE) {
@@ -570,6 +637,7 @@ no_entry_cost: // jump here at the beginning if the node has no parent (it is th
 			segment.m_end_segment_reason = end_segment_reason & ESRB_CACHED_MASK;
 			/* Save end of segment back to the node. */
 			n.SetLastTileTrackdir(cur.tile, cur.td);
+			if (collect_tiles) Yapf().PfNodeCacheSetTiles(n, m_segment_tiles);
 		}
 
 		/* Do we have an excuse why not to continue pathfinding in this direction? */
@@ -630,6 +698,11 @@ no_entry_cost: // jump here at the beginning if the node has no parent (it is th
 	{
 		m_disable_cache = disable;
 	}
+
+	inline bool IsCacheDisabled() const
+	{
+		return m_disable_cache;
+	}
 };
 
 #endif /* YAPF_COSTRAIL_HPP */
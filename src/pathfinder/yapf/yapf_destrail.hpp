@@ -163,6 +163,21 @@ public:
 		CYapfDestinationRailBase::SetDestination(v);
 	}
 
+	/**
+	 * Get what the search aims for, to tell searches for different destinations apart.
+	 * @param[out] tile The tile the estimate aims for.
+	 * @param[out] trackdirs The trackdirs on \a tile that are a destination.
+	 * @param[out] station The destination station, or INVALID_STATION.
+	 * @param[out] any_depot Whether any depot is a destination.
+	 */
+	inline void GetDestination(TileIndex &tile, TrackdirBits &trackdirs, StationID &station, bool &any_depot) const
+	{
+		tile = m_destTile;
+		trackdirs = m_destTrackdirs;
+		station = m_dest_station_id;
+		any_depot = m_any_depot;
+	}
+
 	/** Called by YAPF to detect if node ends in the desired destination */
 	inline bool PfDetectDestination(Node &n)
 	{
@@ -114,6 +114,27 @@ struct CYapfRailSegment
 	}
 };
 
+/**
+ * State of the rail network that changes without a layout change and that a
+ * search looked at: a signal state or the penalty for passing reserved tiles.
+ */
+struct CYapfRailStateEntry
+{
+	TileIndex m_tile;
+	Trackdir  m_td;
+	int       m_skipped; ///< Skipped tiles for a reservation penalty, or -1 for a signal state.
+	int       m_value;   ///< The signal state or the reservation penalty.
+};
+
+/** Segment of a found path, as far as needed to reserve it. */
+struct CYapfRailPathSegment
+{
+	TileIndex m_tile;
+	Trackdir  m_td;
+	TileIndex m_last_tile;
+	Trackdir  m_last_td;
+};
+
 /** Yapf Node for rail YAPF */
 template <class Tkey_>
 struct CYapfRailNodeT
@@ -10,6 +10,167 @@
 #ifndef YAPF_NODE_ROAD_HPP
 #define YAPF_NODE_ROAD_HPP
 
+/**
+ * Key for cached road segments. Besides the origin of the segment it holds
+ * what the walk along the segment depends on of the vehicle: whether it is a
+ * road vehicle or a tram, and the road types it can drive on.
+ */
+struct CYapfRoadSegmentKey
+{
+	uint32    m_value;      ///< Origin tile, road/tram type and origin trackdir.
+	RoadTypes m_compatible; ///< Road types the vehicle can drive on.
+
+	inline CYapfRoadSegmentKey(TileIndex tile, Trackdir td, RoadTramType rtt, RoadTypes compatible)
+		: m_value((static_cast<uint32>(tile) << 5) | (rtt << 4) | td), m_compatible(compatible)
+	{}
+
+	inline int32 CalcHash() const
+	{
+		return m_value ^ (uint32)m_compatible ^ (uint32)(m_compatible >> 32);
+	}
+
+	inline TileIndex GetTile() const
+	{
+		return (TileIndex)(m_value >> 5);
+	}
+
+	inline Trackdir GetTrackdir() const
+	{
+		return (Trackdir)(m_value & 0x0F);
+	}
+
+	inline bool operator==(const CYapfRoadSegmentKey &other) const
+	{
+		return m_value == other.m_value && m_compatible == other.m_compatible;
+	}
+};
+
+/**
+ * Speed limits along a road segment, merged into runs of consecutive steps
+ * with the same limit. The speed penalty depends on the vehicle, so only the
+ * limits are cached.
+ */
+struct CYapfRoadSpeedLimits
+{
+	/** Consecutive steps with the same speed limit. */
+	struct Run {
+		int  max_speed; ///< Maximum speed of the steps.
+		int  min_speed; ///< Minimum speed of the steps.
+		int  weight;    ///< Length weight of each step; 4 plus the skipped tunnel/bridge tiles.
+		uint steps;     ///< Number of steps.
+	};
+
+	static const uint MAX_RUNS = 4; ///< Segments with more speed limit changes are not cached.
+
+	uint m_num_runs;
+	Run  m_runs[MAX_RUNS];
+
+	inline CYapfRoadSpeedLimits() : m_num_runs(0) {}
+
+	/**
+	 * Penalty for one step along the segment.
+	 * @param max_veh_speed Maximum speed of the vehicle.
+	 * @param max_speed Maximum speed of the step.
+	 * @param min_speed Minimum speed of the step.
+	 * @param weight Length weight of the step.
+	 * @return The penalty.
+	 */
+	static inline int StepPenalty(int max_veh_speed, int max_speed, int min_speed, int weight)
+	{
+		int cost = 0;
+		if (max_speed < max_veh_speed) cost += YAPF_TILE_LENGTH * (max_veh_speed - max_speed) * weight / max_veh_speed;
+		if (min_speed > max_veh_speed) cost += YAPF_TILE_LENGTH * (min_speed - max_veh_speed);
+		return cost;
+	}
+
+	/**
+	 * Add a step to the speed limits.
+	 * @return False when there is no room for another run.
+	 */
+	inline bool Add(int max_speed, int min_speed, int weight)
+	{
+		if (m_num_runs > 0) {
+			Run &last = m_runs[m_num_runs - 1];
+			if (last.max_speed == max_speed && last.min_speed == min_speed && last.weight == weight) {
+				last.steps++;
+				return true;
+			}
+		}
+		if (m_num_runs == MAX_RUNS) return false;
+		m_runs[m_num_runs++] = {max_speed, min_speed, weight, 1};
+		return true;
+	}
+
+	/**
+	 * Penalty for all steps along the segment; equal to the sum of their #StepPenalty.
+	 * @param max_veh_speed Maximum speed of the vehicle.
+	 * @return The penalty.
+	 */
+	inline int Penalty(int max_veh_speed) const
+	{
+		int cost = 0;
+		for (uint i = 0; i < m_num_runs; i++) {
+			cost += m_runs[i].steps * StepPenalty(max_veh_speed, m_runs[i].max_speed, m_runs[i].min_speed, m_runs[i].weight);
+		}
+		return cost;
+	}
+};
+
+/**
+ * Cached walk along a road segment for road YAPF. Only segments without
+ * road stops and depots are cached, as the costs of those depend on the
+ * occupancy of the stops and on the vehicle.
+ */
+struct CYapfRoadSegment
+{
+	typedef CYapfRoadSegmentKey Key;
+
+	CYapfRoadSegmentKey  m_key;
+	TileIndex            m_last_tile;
+	Trackdir             m_last_td;
+	int                  m_cost;         ///< Cost of the segment without the speed penalties.
+	CYapfRoadSpeedLimits m_speed_limits;
+	CYapfRoadSegment    *m_hash_next;
+
+	inline CYapfRoadSegment(const CYapfRoadSegmentKey &key)
+		: m_key(key)
+		, m_last_tile(INVALID_TILE)
+		, m_last_td(INVALID_TRACKDIR)
+		, m_cost(-1)
+		, m_hash_next(nullptr)
+	{}
+
+	/**
+	 * Whether a segment passing the given tile, or ending in front of it, can be cached.
+	 * @param tile The tile.
+	 * @return True unless it is a road stop or depot (or another station tile).
+	 */
+	static inline bool IsCacheableTile(TileIndex tile)
+	{
+		return !IsTileType(tile, MP_STATION) && !IsRoadDepotTile(tile);
+	}
+
+	inline const Key& GetKey() const
+	{
+		return m_key;
+	}
+
+	inline TileIndex GetTile() const
+	{
+		return m_key.GetTile();
+	}
+
+	inline CYapfRoadSegment *GetHashNext() const
+	{
+		return m_hash_next;
+	}
+
+	inline void SetHashNext(CYapfRoadSegment *next)
+	{
+		m_hash_next = next;
+	}
+};
+
 /** Yapf Node for road YAPF */
 template <class Tkey_>
 struct CYapfRoadNodeT : CYapfNodeT<Tkey_, CYapfRoadNodeT<Tkey_> > {
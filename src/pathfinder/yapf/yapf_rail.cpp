@@ -16,6 +16,7 @@
 #include "yapf_destrail.hpp"
 #include "../../viewport_func.h"
 #include "../../newgrf_station.h"
+#include "../../console_func.h"
 
 #include "../../safeguards.h"
 
@@ -34,6 +35,15 @@ template <typename Tpf> void DumpState(Tpf &pf1, Tpf &pf2)
 	fclose(f2);
 }
 
+/** A path to reserve for a train. */
+struct CYapfRailReservation
+{
+	std::vector<CYapfRailPathSegment> m_path; ///< Segments of the path, from the reservation target back to the origin.
+	TileIndex m_dest;                         ///< The reservation target tile.
+	Trackdir  m_dest_td;                      ///< The reservation target trackdir.
+	bool      m_notify;                       ///< Whether reserving the path invalidates the segment costs that mask reservations.
+};
+
 template <class Types>
 class CYapfReserveTrack
 {
@@ -106,6 +116,25 @@ private:
 		return tile != m_res_dest || td != m_res_dest_td;
 	}
 
+	/** Call a function for the tiles of a path segment, see CYapfRailNodeT::IterateTiles. */
+	bool IterateSegmentTiles(const CYapfRailPathSegment &segment, bool (CYapfReserveTrack<Types>::*func)(TileIndex, Trackdir))
+	{
+		TrackFollower ft(Yapf().GetVehicle(), Yapf().GetCompatibleRailTypes());
+		TileIndex cur = segment.m_tile;
+		Trackdir  cur_td = segment.m_td;
+
+		while (cur != segment.m_last_tile || cur_td != segment.m_last_td) {
+			if (!(this->*func)(cur, cur_td)) return false;
+
+			if (!ft.Follow(cur, cur_td)) break;
+			cur = ft.m_new_tile;
+			assert(KillFirstBit(ft.m_new_td_bits) == TRACKDIR_BIT_NONE);
+			cur_td = FindFirstTrackdir(ft.m_new_td_bits);
+		}
+
+		return (this->*func)(cur, cur_td);
+	}
+
 	/** Unreserve a single track/platform. Stops when the previous failer is reached. */
 	bool UnreserveSingleTrack(TileIndex tile, Trackdir td)
 	{
@@ -144,9 +173,41 @@ public:
 		}
 	}
 
+	/**
+	 * Get the path till the reservation target, so it can be reserved without the nodes.
+	 * @param[out] res The path and the reservation target.
+	 */
+	void GetReservation(CYapfRailReservation &res)
+	{
+		res.m_path.clear();
+		for (Node *node = m_res_node; node->m_parent != nullptr; node = node->m_parent) {
+			res.m_path.push_back({node->GetTile(), node->GetTrackdir(), node->GetLastTile(), node->GetLastTrackdir()});
+		}
+		res.m_dest = m_res_dest;
+		res.m_dest_td = m_res_dest_td;
+		res.m_notify = Yapf().CanUseGlobalCache(*m_res_node);
+	}
+
 	/** Try to reserve the path till the reservation target. */
 	bool TryReservePath(PBSTileInfo *target, TileIndex origin)
 	{
+		CYapfRailReservation res;
+		this->GetReservation(res);
+		return this->TryReservePath(res, target, origin);
+	}
+
+	/**
+	 * Try to reserve a path till its reservation target.
+	 * @param res The path and the reservation target.
+	 * @param[out] target If not nullptr, the reservation target and whether it was reserved.
+	 * @param origin The tile the reservation starts from.
+	 * @return True if the path was reserved.
+	 */
+	bool TryReservePath(const CYapfRailReservation &res, PBSTileInfo *target, TileIndex origin)
+	{
+		const std::vector<CYapfRailPathSegment> &path = res.m_path;
+		m_res_dest = res.m_dest;
+		m_res_dest_td = res.m_dest_td;
 		m_res_fail_tile = INVALID_TILE;
 		m_origin_tile = origin;
 
@@ -159,17 +220,16 @@ public:
 		/* Don't bother if the target is reserved. */
 		if (!IsWaitingPositionFree(Yapf().GetVehicle(), m_res_dest, m_res_dest_td)) return false;
 
-		for (Node *node = m_res_node; node->m_parent != nullptr; node = node->m_parent) {
-			node->IterateTiles(Yapf().GetVehicle(), Yapf(), *this, &CYapfReserveTrack<Types>::ReserveSingleTrack);
+		for (size_t i = 0; i < path.size(); i++) {
+			this->IterateSegmentTiles(path[i], &CYapfReserveTrack<Types>::ReserveSingleTrack);
 			if (m_res_fail_tile != INVALID_TILE) {
 				/* Reservation failed, undo. */
-				Node *fail_node = m_res_node;
 				TileIndex stop_tile = m_res_fail_tile;
-				do {
-					/* If this is the node that failed, stop at the failed tile. */
-					m_res_fail_tile = fail_node == node ? stop_tile : INVALID_TILE;
-					fail_node->IterateTiles(Yapf().GetVehicle(), Yapf(), *this, &CYapfReserveTrack<Types>::UnreserveSingleTrack);
-				} while (fail_node != node && (fail_node = fail_node->m_parent) != nullptr);
+				for (size_t j = 0; j <= i; j++) {
+					/* If this is the segment that failed, stop at the failed tile. */
+					m_res_fail_tile = j == i ? stop_tile : INVALID_TILE;
+					this->IterateSegmentTiles(path[j], &CYapfReserveTrack<Types>::UnreserveSingleTrack);
+				}
 
 				return false;
 			}
@@ -177,14 +237,61 @@ public:
 
 		if (target != nullptr) target->okay = true;
 
-		if (Yapf().CanUseGlobalCache(*m_res_node)) {
-			YapfNotifyTrackLayoutChange(INVALID_TILE, INVALID_TRACK);
+		if (res.m_notify) {
+			CSegmentCostCacheBase::NotifyReservationChange();
 		}
 
 		return true;
 	}
 };
 
+/** What a search for the nearest depot of a train depends on, besides the track layout, signal states and reservations. */
+struct CYapfRailDepotKey
+{
+	TileIndex m_tile;
+	Trackdir  m_td;
+	TileIndex m_tile_rev;             ///< Tile of the end of the train, for reversing.
+	Trackdir  m_td_rev;
+	int       m_max_penalty;
+	int       m_reverse_penalty;
+	RailTypes m_compatible_railtypes;
+	Owner     m_owner;                ///< Owner of the train, for the tracks it may use.
+	uint      m_length;               ///< Length of the train in tiles, for the platform length penalties.
+	int       m_max_speed;            ///< Maximum speed of the train, for the speed limit penalties.
+	bool      m_forbid_90_deg;
+
+	inline bool operator==(const CYapfRailDepotKey &other) const
+	{
+		return m_tile == other.m_tile && m_td == other.m_td && m_tile_rev == other.m_tile_rev && m_td_rev == other.m_td_rev
+			&& m_max_penalty == other.m_max_penalty && m_reverse_penalty == other.m_reverse_penalty
+			&& m_compatible_railtypes == other.m_compatible_railtypes && m_owner == other.m_owner
+			&& m_length == other.m_length && m_max_speed == other.m_max_speed
+			&& m_forbid_90_deg == other.m_forbid_90_deg;
+	}
+
+	/** Hash function for the depot cache. */
+	struct Hash {
+		inline size_t operator()(const CYapfRailDepotKey &key) const
+		{
+			return (static_cast<size_t>(key.m_tile) << 4 | key.m_td) ^ (static_cast<size_t>(key.m_tile_rev) << 12) ^ key.m_max_penalty;
+		}
+	};
+};
+
+typedef CDepotSearchCacheT<CYapfRailDepotKey, std::vector<CYapfRailStateEntry>> CYapfRailDepotCache;
+
+/**
+ * Get the cache of depot searches of trains, with the results of an
+ * earlier track layout or other settings removed.
+ * @return The cache.
+ */
+static CYapfRailDepotCache &GetRailDepotCache()
+{
+	static CYapfRailDepotCache C;
+	C.Update();
+	return C;
+}
+
 template <class Types>
 class CYapfFollowAnyDepotRailT
 {
@@ -234,7 +341,26 @@ public:
 		 * depot orders and you do not disable automatic servicing.
 		 */
 		if (max_penalty != 0) pf1.DisableCache(true);
+
+		/* Reuse the depot found by an earlier search from here, if a new search would find it too.
+		 * The penalty for occupied platforms of a waypoint the train heads for is not logged, see
+		 * CYapfCostRailT::PfCalcCost, so those searches are always made. */
+		CYapfRailDepotCache *cache = nullptr;
+		CYapfRailDepotKey key;
+		std::vector<CYapfRailStateEntry> state;
+		if (!v->current_order.IsType(OT_GOTO_WAYPOINT) || Waypoint::Get(v->current_order.GetDestination())->IsSingleTile()) {
+			cache = &GetRailDepotCache();
+			key = {t1, td1, t2, td2, max_penalty, reverse_penalty, v->compatible_railtypes, v->owner,
+					CeilDiv(v->gcache.cached_total_length, TILE_SIZE), std::min<int>(v->GetDisplayMaxSpeed(), v->current_order.GetMaxSpeed()),
+					!TrackFollower::Allow90degTurns()};
+			const CYapfRailDepotCache::Result *result = cache->Find(key, [&pf1](const std::vector<CYapfRailStateEntry> &state_log) { return pf1.IsStateUnchanged(state_log); });
+			if (result != nullptr) return result->m_depot;
+			pf1.SetStateLog(&state);
+		}
+
 		FindDepotData result1 = pf1.FindNearestDepotTwoWay(v, t1, td1, t2, td2, max_penalty, reverse_penalty);
+		pf1.SetStateLog(nullptr);
+		if (cache != nullptr) cache->Add(key, result1, std::move(state));
 
 		if (_debug_desync_level >= 2) {
 			Tpf pf2;
@@ -359,6 +485,99 @@ public:
 	}
 };
 
+/** What the path for a train depends on, besides the track layout, signal states and reservations. */
+struct CYapfRailRouteKey
+{
+	TileIndex    m_origin_tile;
+	Trackdir     m_origin_td;
+	TileIndex    m_dest_tile;            ///< Tile the estimate aims for.
+	TrackdirBits m_dest_trackdirs;
+	StationID    m_dest_station;
+	bool         m_any_depot;
+	RailTypes    m_compatible_railtypes;
+	Owner        m_owner;                ///< Owner of the train, for the tracks it may use.
+	uint         m_length;               ///< Length of the train in tiles, for the platform length penalties.
+	int          m_max_speed;            ///< Maximum speed of the train, for the speed limit penalties.
+	bool         m_forbid_90_deg;
+
+	inline bool operator==(const CYapfRailRouteKey &other) const
+	{
+		return m_origin_tile == other.m_origin_tile && m_origin_td == other.m_origin_td
+			&& m_dest_tile == other.m_dest_tile && m_dest_trackdirs == other.m_dest_trackdirs
+			&& m_dest_station == other.m_dest_station && m_any_depot == other.m_any_depot
+			&& m_compatible_railtypes == other.m_compatible_railtypes && m_owner == other.m_owner
+			&& m_length == other.m_length && m_max_speed == other.m_max_speed
+			&& m_forbid_90_deg == other.m_forbid_90_deg;
+	}
+
+	/** Hash function for the route cache. */
+	struct Hash {
+		inline size_t operator()(const CYapfRailRouteKey &key) const
+		{
+			return (static_cast<size_t>(key.m_origin_tile) << 4 | key.m_origin_td) ^ (static_cast<size_t>(key.m_dest_tile) << 12) ^ key.m_dest_station;
+		}
+	};
+};
+
+/** Outcome of a search for a train, and the state it depends on. */
+struct CYapfRailRoute
+{
+	std::vector<CYapfRailStateEntry> m_state; ///< Signal states and reservations the search looked at.
+	Trackdir  m_next_trackdir;                ///< Trackdir to take, or INVALID_TRACKDIR when there is no path at all.
+	bool      m_path_found;                   ///< Whether the path reaches the destination.
+	bool      m_stopped_on_first_two_way_signal;
+	TileIndex m_dest_tile;                    ///< Last tile of the path.
+	TileIndex m_origin_tile;                  ///< Tile the reservation starts from.
+	CYapfRailReservation m_reservation;       ///< The path to reserve.
+};
+
+/**
+ * Paths found for trains, to be reused by trains with the same origin and
+ * destination. A path is only reused when the signal states and reservations
+ * the search looked at did not change, so a new search would find the same.
+ * The cache only holds paths of the current track layout and settings.
+ */
+struct CYapfRailRouteCache
+{
+	static const size_t MAX_ROUTES = 1024;        ///< The cache is emptied when it holds this many paths.
+	static const size_t MAX_STATE_ENTRIES = 2048; ///< Paths depending on more state are not cached.
+
+	typedef std::unordered_map<CYapfRailRouteKey, CYapfRailRoute, CYapfRailRouteKey::Hash> Routes;
+
+	Routes       m_routes;
+	uint64       m_layout_generation = 0; ///< #CSegmentCostCacheBase::GetLayoutGeneration of the paths.
+	YAPFSettings m_settings = {};         ///< Pathfinder settings of the paths.
+
+	static uint64 s_hits;        ///< Number of paths reused.
+	static uint64 s_misses;      ///< Number of searches without a path for the train in the cache.
+	static uint64 s_invalidated; ///< Number of paths dropped as the signal states or reservations changed.
+
+	inline void Add(const CYapfRailRouteKey &key, CYapfRailRoute &&route)
+	{
+		if (route.m_state.size() > MAX_STATE_ENTRIES) return;
+		if (m_routes.size() >= MAX_ROUTES) m_routes.clear();
+		m_routes.emplace(key, std::move(route));
+	}
+};
+
+uint64 CYapfRailRouteCache::s_hits = 0;
+uint64 CYapfRailRouteCache::s_misses = 0;
+uint64 CYapfRailRouteCache::s_invalidated = 0;
+
+static CYapfRailRouteCache &GetRailRouteCache()
+{
+	static CYapfRailRouteCache C;
+
+	/* Any change of the layout or the settings may change every path. */
+	uint64 layout_generation = CSegmentCostCacheBase::GetLayoutGeneration();
+	if (C.m_layout_generation != layout_generation || memcmp(&C.m_settings, &_settings_game.pf.yapf, sizeof(YAPFSettings)) != 0) {
+		C.m_routes.clear();
+		C.m_layout_generation = layout_generation;
+		memcpy(&C.m_settings, &_settings_game.pf.yapf, sizeof(YAPFSettings));
+	}
+	return C;
+}
+
 template <class Types>
 class CYapfFollowRailT : public CYapfReserveTrack<Types>
 {
@@ -427,8 +646,31 @@ public:
 		Yapf().SetOrigin(origin.tile, origin.trackdir, INVALID_TILE, INVALID_TRACKDIR, 1, true);
 		Yapf().SetDestination(v);
 
+		/* Reuse the path found for an earlier train if a new search would find it too. */
+		CYapfRailRouteCache *route_cache = nullptr;
+		CYapfRailRouteKey route_key;
+		CYapfRailRoute route;
+		if (!Yapf().IsCacheDisabled()) {
+			route_cache = &GetRailRouteCache();
+			route_key = this->GetRouteKey(v, origin);
+			CYapfRailRouteCache::Routes::iterator it = route_cache->m_routes.find(route_key);
+			if (it == route_cache->m_routes.end()) {
+				CYapfRailRouteCache::s_misses++;
+			} else if (Yapf().IsStateUnchanged(it->second.m_state)) {
+				CYapfRailRouteCache::s_hits++;
+				/* Reserving the path needs the vehicle, which is otherwise only set by the search. */
+				Yapf().SetVehicle(v);
+				return this->FollowCachedRoute(it->second, path_found, reserve_track, target, dest);
+			} else {
+				CYapfRailRouteCache::s_invalidated++;
+				route_cache->m_routes.erase(it);
+			}
+			Yapf().SetStateLog(&route.m_state);
+		}
+
 		/* find the best path */
 		path_found = Yapf().FindPath(v);
+		Yapf().SetStateLog(nullptr);
 
 		/* if path not found - return INVALID_TRACKDIR */
 		Trackdir next_trackdir = INVALID_TRACKDIR;
@@ -450,17 +692,59 @@ public:
 			Node &best_next_node = *pPrev;
 			next_trackdir = best_next_node.GetTrackdir();
 
+			if (route_cache != nullptr) {
+				route.m_dest_tile = Yapf().GetBestNode()->GetLastTile();
+				route.m_origin_tile = pNode->GetLastTile();
+				this->GetReservation(route.m_reservation);
+			}
+
 			if (reserve_track && path_found) {
 				if (dest != nullptr) *dest = Yapf().GetBestNode()->GetLastTile();
 				this->TryReservePath(target, pNode->GetLastTile());
 			}
 		}
 
+		if (route_cache != nullptr) {
+			route.m_next_trackdir = next_trackdir;
+			route.m_path_found = path_found;
+			route.m_stopped_on_first_two_way_signal = Yapf().m_stopped_on_first_two_way_signal;
+			route_cache->Add(route_key, std::move(route));
+		}
+
 		/* Treat the path as found if stopped on the first two way signal(s). */
 		path_found |= Yapf().m_stopped_on_first_two_way_signal;
 		return next_trackdir;
 	}
 
+	/** Get the key of the path for a train in the route cache. */
+	inline CYapfRailRouteKey GetRouteKey(const Train *v, const PBSTileInfo &origin)
+	{
+		CYapfRailRouteKey key;
+		key.m_origin_tile = origin.tile;
+		key.m_origin_td = origin.trackdir;
+		Yapf().GetDestination(key.m_dest_tile, key.m_dest_trackdirs, key.m_dest_station, key.m_any_depot);
+		key.m_compatible_railtypes = Yapf().GetCompatibleRailTypes();
+		key.m_owner = v->owner;
+		key.m_length = CeilDiv(v->gcache.cached_total_length, TILE_SIZE);
+		key.m_max_speed = std::min<int>(v->GetDisplayMaxSpeed(), v->current_order.GetMaxSpeed());
+		key.m_forbid_90_deg = !TrackFollower::Allow90degTurns();
+		return key;
+	}
+
+	/** Do what #ChooseRailTrack does after the search, for a path found before. */
+	inline Trackdir FollowCachedRoute(const CYapfRailRoute &route, bool &path_found, bool reserve_track, PBSTileInfo *target, TileIndex *dest)
+	{
+		path_found = route.m_path_found;
+		if (route.m_next_trackdir != INVALID_TRACKDIR && reserve_track && path_found) {
+			if (dest != nullptr) *dest = route.m_dest_tile;
+			this->TryReservePath(route.m_reservation, target, route.m_origin_tile);
+		}
+
+		/* Treat the path as found if stopped on the first two way signal(s). */
+		path_found |= route.m_stopped_on_first_two_way_signal;
+		return route.m_next_trackdir;
+	}
+
 	static bool stCheckReverseTrain(const Train *v, TileIndex t1, Trackdir td1, TileIndex t2, Trackdir td2, int reverse_penalty)
 	{
 		Tpf pf1;
@@ -638,10 +922,64 @@ bool YapfTrainFindNearestSafeTile(const Train *v, TileIndex tile, Trackdir td, b
 	return pfnFindNearestSafeTile(v, tile, td, override_railtype);
 }
 
-/** if any track changes, this counter is incremented - that will invalidate segment cost cache */
+/** if any track or reservation changes, this counter is incremented - that will invalidate the segment cost caches that mask reservations */
 int CSegmentCostCacheBase::s_rail_change_counter = 0;
+std::vector<TileIndex> CSegmentCostCacheBase::s_changed_tiles;
+uint64 CSegmentCostCacheBase::s_changed_tiles_offset = 0;
+uint64 CSegmentCostCacheBase::s_hits = 0;
+uint64 CSegmentCostCacheBase::s_misses = 0;
+uint64 CSegmentCostCacheBase::s_road_hits = 0;
+uint64 CSegmentCostCacheBase::s_road_misses = 0;
+uint64 CSegmentCostCacheBase::s_evictions = 0;
+uint64 CSegmentCostCacheBase::s_flushes = 0;
+uint64 CDepotSearchCacheBase::s_hits = 0;
+uint64 CDepotSearchCacheBase::s_misses = 0;
+uint64 CDepotSearchCacheBase::s_invalidated = 0;
 
 void YapfNotifyTrackLayoutChange(TileIndex tile, Track track)
 {
 	CSegmentCostCacheBase::NotifyTrackLayoutChange(tile, track);
 }
+
+/**
+ * Print the statistics of the rail and road segment cost caches, the train route cache, the depot search caches and the node pools to the console.
+ * @param reset Whether to reset the counters after printing them.
+ */
+void ConPrintYapfCacheStatistics(bool reset)
+{
+	uint64 lookups = CSegmentCostCacheBase::s_hits + CSegmentCostCacheBase::s_misses;
+	IConsolePrint(CC_INFO, "Rail segment cache: {} hits, {} misses ({:.1f}% hit rate).",
+			CSegmentCostCacheBase::s_hits, CSegmentCostCacheBase::s_misses, lookups == 0 ? 0.0 : 100.0 * CSegmentCostCacheBase::s_hits / lookups);
+	uint64 road_lookups = CSegmentCostCacheBase::s_road_hits + CSegmentCostCacheBase::s_road_misses;
+	IConsolePrint(CC_INFO, "Road segment cache: {} hits, {} misses ({:.1f}% hit rate).",
+			CSegmentCostCacheBase::s_road_hits, CSegmentCostCacheBase::s_road_misses, road_lookups == 0 ? 0.0 : 100.0 * CSegmentCostCacheBase::s_road_hits / road_lookups);
+	IConsolePrint(CC_INFO, "  {} segments evicted by track and road changes, {} complete flushes, {} changes logged.",
+			CSegmentCostCacheBase::s_evictions, CSegmentCostCacheBase::s_flushes, CSegmentCostCacheBase::GetLayoutGeneration());
+	uint64 route_lookups = CYapfRailRouteCache::s_hits + CYapfRailRouteCache::s_misses + CYapfRailRouteCache::s_invalidated;
+	IConsolePrint(CC_INFO, "Train route cache: {} paths reused, {} not cached, {} outdated by signals or reservations ({:.1f}% reuse rate).",
+			CYapfRailRouteCache::s_hits, CYapfRailRouteCache::s_misses, CYapfRailRouteCache::s_invalidated,
+			route_lookups == 0 ? 0.0 : 100.0 * CYapfRailRouteCache::s_hits / route_lookups);
+	uint64 depot_lookups = CDepotSearchCacheBase::s_hits + CDepotSearchCacheBase::s_misses + CDepotSearchCacheBase::s_invalidated;
+	IConsolePrint(CC_INFO, "Depot searches: {} answered from the caches, {} not cached, {} outdated by signals, reservations or road stops ({:.1f}% reuse rate).",
+			CDepotSearchCacheBase::s_hits, CDepotSearchCacheBase::s_misses, CDepotSearchCacheBase::s_invalidated,
+			depot_lookups == 0 ? 0.0 : 100.0 * CDepotSearchCacheBase::s_hits / depot_lookups);
+	IConsolePrint(CC_INFO, "Node pools: {} searches, {} pools allocated, at most {} nodes in one search.",
+			CNodeListStats::s_searches.load(), CNodeListStats::s_pools.load(), CNodeListStats::s_peak_nodes.load());
+
+	if (reset) {
+		CSegmentCostCacheBase::s_hits = 0;
+		CSegmentCostCacheBase::s_misses = 0;
+		CSegmentCostCacheBase::s_road_hits = 0;
+		CSegmentCostCacheBase::s_road_misses = 0;
+		CSegmentCostCacheBase::s_evictions = 0;
+		CSegmentCostCacheBase::s_flushes = 0;
+		CYapfRailRouteCache::s_hits = 0;
+		CYapfRailRouteCache::s_misses = 0;
+		CYapfRailRouteCache::s_invalidated = 0;
+		CDepotSearchCacheBase::s_hits = 0;
+		CDepotSearchCacheBase::s_misses = 0;
+		CDepotSearchCacheBase::s_invalidated = 0;
+		CNodeListStats::s_searches = 0;
+		CNodeListStats::s_peak_nodes = 0;
+	}
+}
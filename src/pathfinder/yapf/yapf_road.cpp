@@ -9,11 +9,104 @@
 
 #include "../../stdafx.h"
 #include "yapf.hpp"
+#include "yapf_cache.h"
 #include "yapf_node_road.hpp"
 #include "../../roadstop_base.h"
 
 #include "../../safeguards.h"
 
+typedef CSegmentCostCacheT<CYapfRoadSegment> CRoadSegmentCache;
+
+/**
+ * Get the cache of road segments shared by all road YAPF types.
+ * @return The cache.
+ */
+static CRoadSegmentCache &GetRoadSegmentCache()
+{
+	static CRoadSegmentCache C;
+	return C;
+}
+
+void YapfRoadUpdateCaches()
+{
+	static uint32 last_penalties[3] = {};
+	CRoadSegmentCache &C = GetRoadSegmentCache();
+
+	/* The cached costs include these penalties, so changing them invalidates everything. */
+	const YAPFSettings &settings = _settings_game.pf.yapf;
+	uint32 penalties[3] = {settings.road_curve_penalty, settings.road_crossing_penalty, settings.road_slope_penalty};
+	if (!std::equal(std::begin(penalties), std::end(penalties), std::begin(last_penalties))) {
+		std::copy(std::begin(penalties), std::end(penalties), std::begin(last_penalties));
+		C.Flush();
+	}
+
+	C.ProcessChanges();
+}
+
+/**
+ * Get the part of the cost of a road stop tile that depends on the vehicles using the road stop.
+ * @param tile The road stop tile.
+ * @param trackdir The trackdir the road stop is passed in.
+ * @return The occupancy cost.
+ */
+static int GetRoadStopOccupancyCost(TileIndex tile, Trackdir trackdir)
+{
+	const YAPFSettings &settings = _settings_game.pf.yapf;
+	const RoadStop *rs = RoadStop::GetByTile(tile, GetRoadStopType(tile));
+	if (IsDriveThroughStopTile(tile)) {
+		DiagDirection dir = TrackdirToExitdir(trackdir);
+		if (RoadStop::IsDriveThroughRoadStopContinuation(tile, tile - TileOffsByDiagDir(dir))) return 0;
+
+		/* When we're the first road stop in a 'queue' of them we increase
+		 * cost based on the fill percentage of the whole queue. */
+		const RoadStop::Entry *entry = rs->GetEntry(dir);
+		return entry->GetOccupied() * settings.road_stop_occupied_penalty / entry->GetLength();
+	}
+
+	/* Increase cost for filled road stops */
+	return settings.road_stop_bay_occupied_penalty * (!rs->IsFreeBay(0) + !rs->IsFreeBay(1)) / 2;
+}
+
+/** What a search for the nearest depot of a road vehicle depends on, besides the road layout and road stop occupancy. */
+struct CYapfRoadDepotKey
+{
+	TileIndex m_tile;
+	Trackdir  m_td;
+	Owner     m_owner;                ///< Owner of the vehicle, for the depots it may enter.
+	RoadType  m_roadtype;
+	RoadTypes m_compatible_roadtypes;
+	int       m_max_speed;            ///< Maximum speed of the vehicle, for the speed limit penalties.
+	int       m_max_distance;
+
+	inline bool operator==(const CYapfRoadDepotKey &other) const
+	{
+		return m_tile == other.m_tile && m_td == other.m_td && m_owner == other.m_owner
+			&& m_roadtype == other.m_roadtype && m_compatible_roadtypes == other.m_compatible_roadtypes
+			&& m_max_speed == other.m_max_speed && m_max_distance == other.m_max_distance;
+	}
+
+	/** Hash function for the depot cache. */
+	struct Hash {
+		inline size_t operator()(const CYapfRoadDepotKey &key) const
+		{
+			return (static_cast<size_t>(key.m_tile) << 4 | key.m_td) ^ (static_cast<size_t>(key.m_owner) << 28) ^ key.m_max_speed;
+		}
+	};
+};
+
+typedef CDepotSearchCacheT<CYapfRoadDepotKey, RoadVehStopOccupancy> CYapfRoadDepotCache;
+
+/**
+ * Get the cache of depot searches of road vehicles, with the results of an
+ * earlier road layout or other settings removed.
+ * @return The cache.
+ */
+static CYapfRoadDepotCache &GetRoadDepotCache()
+{
+	static CYapfRoadDepotCache C;
+	C.Update();
+	return C;
+}
 
 template <class Types>
 class CYapfCostRoadT
@@ -26,8 +119,12 @@ public:
 
 protected:
 	int m_max_cost;
+	CRoadSegmentCache &m_segment_cache;    ///< Cache of walks along road segments.
+	std::vector<TileIndex> m_segment_tiles; ///< Tiles the walk along the current segment depends on.
+	RoadVehStopOccupancy *m_occupancy_log; ///< If not nullptr, log of the road stops whose occupancy was looked at.
+	bool m_concurrent;                     ///< Whether other searches may run at the same time, so the segment cache may only be read.
 
-	CYapfCostRoadT() : m_max_cost(0) {};
+	CYapfCostRoadT() : m_max_cost(0), m_segment_cache(GetRoadSegmentCache()), m_occupancy_log(nullptr), m_concurrent(false) {};
 
 	/** to access inherited path finder */
 	Tpf& Yapf()
@@ -70,21 +167,12 @@ protected:
 					break;
 
 				case MP_STATION: {
-					const RoadStop *rs = RoadStop::GetByTile(tile, GetRoadStopType(tile));
-					if (IsDriveThroughStopTile(tile)) {
-						/* Increase the cost for drive-through road stops */
-						cost += Yapf().PfGetSettings().road_stop_penalty;
-						DiagDirection dir = TrackdirToExitdir(trackdir);
-						if (!RoadStop::IsDriveThroughRoadStopContinuation(tile, tile - TileOffsByDiagDir(dir))) {
-							/* When we're the first road stop in a 'queue' of them we increase
-							 * cost based on the fill percentage of the whole queue. */
-							const RoadStop::Entry *entry = rs->GetEntry(dir);
-							cost += entry->GetOccupied() * Yapf().PfGetSettings().road_stop_occupied_penalty / entry->GetLength();
-						}
-					} else {
-						/* Increase cost for filled road stops */
-						cost += Yapf().PfGetSettings().road_stop_bay_occupied_penalty * (!rs->IsFreeBay(0) + !rs->IsFreeBay(1)) / 2;
-					}
+					/* Increase the cost for drive-through road stops */
+					if (IsDriveThroughStopTile(tile)) cost += Yapf().PfGetSettings().road_stop_penalty;
+
+					int occupancy_cost = GetRoadStopOccupancyCost(tile, trackdir);
+					if (m_occupancy_log != nullptr) m_occupancy_log->emplace_back(tile, trackdir, occupancy_cost);
+					cost += occupancy_cost;
 					break;
 				}
 
@@ -104,6 +192,21 @@ public:
 		m_max_cost = max_cost;
 	}
 
+	/**
+	 * Set where to log the road stops whose occupancy affects the costs.
+	 * @param occupancy_log The log, or nullptr to not log.
+	 */
+	inline void SetOccupancyLog(RoadVehStopOccupancy *occupancy_log)
+	{
+		m_occupancy_log = occupancy_log;
+	}
+
+	/** Let the search run at the same time as other searches, by only reading the segment cache. */
+	inline void SetConcurrent()
+	{
+		m_concurrent = true;
+	}
+
 	/**
 	 * Called by YAPF to calculate the cost from the origin to the given node.
 	 *  Calculates only the cost of given node, adds it to the parent node cost
@@ -111,24 +214,54 @@ public:
 	 */
 	inline bool PfCalcCost(Node &n, const TrackFollower *tf)
 	{
+		const RoadVehicle *v = Yapf().GetVehicle();
+		int parent_cost = (n.m_parent != nullptr) ? n.m_parent->m_cost : 0;
+		int max_veh_speed = std::min<int>(v->GetDisplayMaxSpeed(), v->current_order.GetMaxSpeed() * 2);
+
+		/* The cache can only be used when the walk can't stop early: at the
+		 * destination, which can't be at a cached segment then, or because
+		 * of the maximum path cost. */
+		bool use_cache = m_max_cost == 0 && !Yapf().IsDestinationOnPlainRoad();
+		CYapfRoadSegmentKey key(n.m_key.m_tile, n.m_key.m_td, GetRoadTramType(v->roadtype), v->compatible_roadtypes);
+		if (use_cache) {
+			/* Look up through a const reference, which doesn't touch the hash table. */
+			const CRoadSegmentCache &cache = m_segment_cache;
+			const CYapfRoadSegment *segment = cache.m_map.Find(key);
+			if (segment != nullptr) {
+				if (!m_concurrent) CSegmentCostCacheBase::s_road_hits++;
+				n.m_segment_last_tile = segment->m_last_tile;
+				n.m_segment_last_td = segment->m_last_td;
+				n.m_cost = parent_cost + segment->m_cost + segment->m_speed_limits.Penalty(max_veh_speed);
+				return true;
+			}
+			if (!m_concurrent) CSegmentCostCacheBase::s_road_misses++;
+			m_segment_tiles.clear();
+		}
+
+		bool cacheable = use_cache && !m_concurrent;
 		int segment_cost = 0;
+		int speed_cost = 0;
+		CYapfRoadSpeedLimits speed_limits;
 		uint tiles = 0;
 		/* start at n.m_key.m_tile / n.m_key.m_td and walk to the end of segment */
 		TileIndex tile = n.m_key.m_tile;
 		Trackdir trackdir = n.m_key.m_td;
-		int parent_cost = (n.m_parent != nullptr) ? n.m_parent->m_cost : 0;
 
 		for (;;) {
 			/* base tile cost depending on distance between edges */
 			segment_cost += Yapf().OneTileCost(tile, trackdir);
 
-			const RoadVehicle *v = Yapf().GetVehicle();
+			if (cacheable) {
+				m_segment_tiles.push_back(tile);
+				cacheable = CYapfRoadSegment::IsCacheableTile(tile);
+			}
+
 			/* we have reached the vehicle's destination - segment should end here to avoid target skipping */
 			if (Yapf().PfDetectDestinationTile(tile, trackdir)) break;
 
 			/* Finish if we already exceeded the maximum path cost (i.e. when
 			 * searching for the nearest depot). */
-			if (m_max_cost > 0 && (parent_cost + segment_cost) > m_max_cost) {
+			if (m_max_cost > 0 && (parent_cost + segment_cost + speed_cost) > m_max_cost) {
 				return false;
 			}
 
@@ -140,7 +273,19 @@ public:
 
 			/* if there are no reachable trackdirs on new tile, we have end of road */
 			TrackFollower F(Yapf().GetVehicle());
-			if (!F.Follow(tile, trackdir)) break;
+			bool followed = F.Follow(tile, trackdir);
+
+			if (cacheable) {
+				/* The walk also depends on the tile in front of this one and
+				 * the tile it continues on, e.g. at the other end of a tunnel. */
+				TileIndex next_tile = TileAddByDiagDir(tile, TrackdirToExitdir(trackdir));
+				m_segment_tiles.push_back(next_tile);
+				if (F.m_new_tile != INVALID_TILE) m_segment_tiles.push_back(F.m_new_tile);
+				cacheable = CYapfRoadSegment::IsCacheableTile(next_tile) &&
+						(F.m_new_tile == INVALID_TILE || CYapfRoadSegment::IsCacheableTile(F.m_new_tile));
+			}
+
+			if (!followed) break;
 
 			/* if there are more trackdirs available & reachable, we are at the end of segment */
 			if (KillFirstBit(F.m_new_td_bits) != TRACKDIR_BIT_NONE) break;
@@ -159,10 +304,9 @@ public:
 
 			/* add min/max speed penalties */
 			int min_speed = 0;
-			int max_veh_speed = std::min<int>(v->GetDisplayMaxSpeed(), v->current_order.GetMaxSpeed() * 2);
 			int max_speed = F.GetSpeedLimit(&min_speed);
-			if (max_speed < max_veh_speed) segment_cost += YAPF_TILE_LENGTH * (max_veh_speed - max_speed) * (4 + F.m_tiles_skipped) / max_veh_speed;
-			if (min_speed > max_veh_speed) segment_cost += YAPF_TILE_LENGTH * (min_speed - max_veh_speed);
+			speed_cost += CYapfRoadSpeedLimits::StepPenalty(max_veh_speed, max_speed, min_speed, 4 + F.m_tiles_skipped);
+			if (cacheable) cacheable = speed_limits.Add(max_speed, min_speed, 4 + F.m_tiles_skipped);
 
 			/* move to the next tile */
 			tile = F.m_new_tile;
@@ -170,12 +314,23 @@ public:
 			if (tiles > MAX_MAP_SIZE) break;
 		}
 
+		if (cacheable) {
+			bool found;
+			CYapfRoadSegment &segment = m_segment_cache.Get(key, &found);
+			assert(!found);
+			segment.m_last_tile = tile;
+			segment.m_last_td = trackdir;
+			segment.m_cost = segment_cost;
+			segment.m_speed_limits = speed_limits;
+			m_segment_cache.SetTiles(segment, m_segment_tiles);
+		}
+
 		/* save end of segment back to the node */
 		n.m_segment_last_tile = tile;
 		n.m_segment_last_td = trackdir;
 
 		/* save also tile cost */
-		n.m_cost = parent_cost + segment_cost;
+		n.m_cost = parent_cost + segment_cost + speed_cost;
 		return true;
 	}
 };
@@ -207,6 +362,12 @@ public:
 		return IsRoadDepotTile(tile);
 	}
 
+	/** Whether the destination can be on a road segment without road stops and depots. */
+	inline bool IsDestinationOnPlainRoad() const
+	{
+		return false;
+	}
+
 	/**
 	 * Called by YAPF to calculate cost estimate. Calculates distance to the destination
 	 *  adds it to the actual cost from origin and stores the sum to the Node::m_estimate
@@ -282,6 +443,13 @@ public:
 		return tile == m_destTile && HasTrackdir(m_destTrackdirs, trackdir);
 	}
 
+	/** Whether the destination can be on a road segment without road stops and depots. */
+	inline bool IsDestinationOnPlainRoad() const
+	{
+		if (m_dest_station != INVALID_STATION || m_destTrackdirs == TRACKDIR_BIT_NONE) return false;
+		return CYapfRoadSegment::IsCacheableTile(m_destTile);
+	}
+
 	/**
 	 * Called by YAPF to calculate cost estimate. Calculates distance to the destination
 	 *  adds it to the actual cost from origin and stores the sum to the Node::m_estimate
@@ -351,9 +519,14 @@ public:
 		return 'r';
 	}
 
-	static Trackdir stChooseRoadTrack(const RoadVehicle *v, TileIndex tile, DiagDirection enterdir, bool &path_found, RoadVehPathCache &path_cache)
+	static Trackdir stChooseRoadTrack(const RoadVehicle *v, TileIndex tile, DiagDirection enterdir, bool &path_found, RoadVehPathCache &path_cache, RoadVehStopOccupancy *occupancy)
 	{
 		Tpf pf;
+		/* Searches logging the occupancy are planned ahead on worker threads. */
+		if (occupancy != nullptr) {
+			pf.SetOccupancyLog(occupancy);
+			pf.SetConcurrent();
+		}
 		return pf.ChooseRoadTrack(v, tile, enterdir, path_found, path_cache);
 	}
 
@@ -477,9 +650,10 @@ public:
 		return true;
 	}
 
-	static FindDepotData stFindNearestDepot(const RoadVehicle *v, TileIndex tile, Trackdir td, int max_distance)
+	static FindDepotData stFindNearestDepot(const RoadVehicle *v, TileIndex tile, Trackdir td, int max_distance, RoadVehStopOccupancy *occupancy)
 	{
 		Tpf pf;
+		pf.SetOccupancyLog(occupancy);
 		return pf.FindNearestDepot(v, tile, td, max_distance);
 	}
 
@@ -529,10 +703,18 @@ struct CYapfRoadAnyDepot1 : CYapfT<CYapfRoad_TypesT<CYapfRoadAnyDepot1, CRoadNod
 struct CYapfRoadAnyDepot2 : CYapfT<CYapfRoad_TypesT<CYapfRoadAnyDepot2, CRoadNodeListExitDir , CYapfDestinationAnyDepotRoadT> > {};
 
 
-Trackdir YapfRoadVehicleChooseTrack(const RoadVehicle *v, TileIndex tile, DiagDirection enterdir, TrackdirBits trackdirs, bool &path_found, RoadVehPathCache &path_cache)
+void YapfNotifyRoadLayoutChange(TileIndex tile)
+{
+	CSegmentCostCacheBase::NotifyTileChange(tile);
+}
+
+Trackdir YapfRoadVehicleChooseTrack(const RoadVehicle *v, TileIndex tile, DiagDirection enterdir, TrackdirBits trackdirs, bool &path_found, RoadVehPathCache &path_cache, RoadVehStopOccupancy *occupancy)
 {
+	/* Searches that log the occupancy rely on the caches being updated beforehand. */
+	if (occupancy == nullptr) YapfRoadUpdateCaches();
+
 	/* default is YAPF type 2 */
-	typedef Trackdir (*PfnChooseRoadTrack)(const RoadVehicle*, TileIndex, DiagDirection, bool &path_found, RoadVehPathCache &path_cache);
+	typedef Trackdir (*PfnChooseRoadTrack)(const RoadVehicle*, TileIndex, DiagDirection, bool &path_found, RoadVehPathCache &path_cache, RoadVehStopOccupancy *occupancy);
 	PfnChooseRoadTrack pfnChooseRoadTrack = &CYapfRoad2::stChooseRoadTrack; // default: ExitDir, allow 90-deg
 
 	/* check if non-default YAPF type should be used */
@@ -540,10 +722,18 @@ Trackdir YapfRoadVehicleChooseTrack(const RoadVehicle *v, TileIndex tile, DiagDi
 		pfnChooseRoadTrack = &CYapfRoad1::stChooseRoadTrack; // Trackdir
 	}
 
-	Trackdir td_ret = pfnChooseRoadTrack(v, tile, enterdir, path_found, path_cache);
+	Trackdir td_ret = pfnChooseRoadTrack(v, tile, enterdir, path_found, path_cache, occupancy);
 	return (td_ret != INVALID_TRACKDIR) ? td_ret : (Trackdir)FindFirstBit2x64(trackdirs);
 }
 
+bool YapfRoadStopOccupancyUnchanged(const RoadVehStopOccupancy &occupancy)
+{
+	for (const auto &it : occupancy) {
+		if (GetRoadStopOccupancyCost(std::get<0>(it), std::get<1>(it)) != std::get<2>(it)) return false;
+	}
+	return true;
+}
+
 FindDepotData YapfRoadVehicleFindNearestDepot(const RoadVehicle *v, int max_distance)
 {
 	TileIndex tile = v->tile;
@@ -553,8 +743,16 @@ FindDepotData YapfRoadVehicleFindNearestDepot(const RoadVehicle *v, int max_dist
 		return FindDepotData();
 	}
 
+	YapfRoadUpdateCaches();
+
+	/* Reuse the depot found by an earlier search from here, if a new search would find it too. */
+	CYapfRoadDepotCache &cache = GetRoadDepotCache();
+	CYapfRoadDepotKey key = {tile, trackdir, v->owner, v->roadtype, v->compatible_roadtypes, std::min<int>(v->GetDisplayMaxSpeed(), v->current_order.GetMaxSpeed() * 2), max_distance};
+	const CYapfRoadDepotCache::Result *result = cache.Find(key, &YapfRoadStopOccupancyUnchanged);
+	if (result != nullptr) return result->m_depot;
+
 	/* default is YAPF type 2 */
-	typedef FindDepotData (*PfnFindNearestDepot)(const RoadVehicle*, TileIndex, Trackdir, int);
+	typedef FindDepotData (*PfnFindNearestDepot)(const RoadVehicle*, TileIndex, Trackdir, int, RoadVehStopOccupancy *);
 	PfnFindNearestDepot pfnFindNearestDepot = &CYapfRoadAnyDepot2::stFindNearestDepot;
 
 	/* check if non-default YAPF type should be used */
@@ -562,5 +760,8 @@ FindDepotData YapfRoadVehicleFindNearestDepot(const RoadVehicle *v, int max_dist
 		pfnFindNearestDepot = &CYapfRoadAnyDepot1::stFindNearestDepot; // Trackdir
 	}
 
-	return pfnFindNearestDepot(v, tile, trackdir, max_distance);
+	RoadVehStopOccupancy occupancy;
+	FindDepotData depot = pfnFindNearestDepot(v, tile, trackdir, max_distance, &occupancy);
+	cache.Add(key, depot, std::move(occupancy));
+	return depot;
 }
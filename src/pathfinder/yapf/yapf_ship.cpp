@@ -14,6 +14,7 @@
 
 #include "yapf.hpp"
 #include "yapf_node_ship.hpp"
+#include "yapf_ship_regions.h"
 
 #include "../../safeguards.h"
 
@@ -31,7 +32,21 @@ protected:
 	TrackdirBits m_destTrackdirs;
 	StationID    m_destStation;
 
+	bool                 m_has_intermediate_dest = false;
+	WaterRegionPatchDesc m_intermediate_dest_patch;
+
 public:
+	/**
+	 * Search for a water region patch on the way to the destination instead of the destination itself.
+	 * @param patch The patch to reach.
+	 */
+	void SetIntermediateDestination(const WaterRegionPatchDesc &patch)
+	{
+		m_has_intermediate_dest = true;
+		m_intermediate_dest_patch = patch;
+		m_destTile = GetWaterRegionCenterTile(patch);
+	}
+
 	void SetDestination(const Ship *v)
 	{
 		if (v->current_order.IsType(OT_GOTO_STATION)) {
@@ -61,6 +76,10 @@ public:
 
 	inline bool PfDetectDestinationTile(TileIndex tile, Trackdir trackdir)
 	{
+		if (m_has_intermediate_dest) {
+			return GetWaterRegionPatchInfo(tile) == m_intermediate_dest_patch;
+		}
+
 		if (m_destStation != INVALID_STATION) {
 			return IsDockingTile(tile) && IsShipDestinationTile(tile, m_destStation);
 		}
@@ -87,12 +106,21 @@ public:
 		int y1 = 2 * TileY(tile) + dg_dir_to_y_offs[(int)exitdir];
 		int x2 = 2 * TileX(m_destTile);
 		int y2 = 2 * TileY(m_destTile);
+		if (m_has_intermediate_dest) {
+			/* Any tile of the region may be part of the patch; aim for the closest one. */
+			const int min_x = 2 * m_intermediate_dest_patch.x * WATER_REGION_EDGE_LENGTH;
+			const int min_y = 2 * m_intermediate_dest_patch.y * WATER_REGION_EDGE_LENGTH;
+			x2 = Clamp(x1, min_x, min_x + 2 * (WATER_REGION_EDGE_LENGTH - 1));
+			y2 = Clamp(y1, min_y, min_y + 2 * (WATER_REGION_EDGE_LENGTH - 1));
+		}
 		int dx = abs(x1 - x2);
 		int dy = abs(y1 - y2);
 		int dmin = std::min(dx, dy);
 		int dxy = abs(dx - dy);
 		int d = dmin * YAPF_TILE_CORNER_LENGTH + (dxy - 1) * (YAPF_TILE_LENGTH / 2);
 		n.m_estimate = n.m_cost + d;
+		/* The distance to a region may shrink faster than the cost grows when passing its corners. */
+		if (m_has_intermediate_dest) n.m_estimate = std::max(n.m_estimate, n.m_parent->m_estimate);
 		assert(n.m_estimate >= n.m_parent->m_estimate);
 		return true;
 	}
@@ -110,6 +138,8 @@ public:
 	typedef typename Node::Key Key;                      ///< key to hash tables
 
 protected:
+	const std::vector<WaterRegionPatchDesc> *m_water_region_corridor = nullptr; ///< If not nullptr, the water region patches the search may enter.
+
 	/** to access inherited path finder */
 	inline Tpf& Yapf()
 	{
@@ -117,6 +147,15 @@ protected:
 	}
 
 public:
+	/**
+	 * Only search the tiles of the given water region patches.
+	 * @param corridor The patches, or nullptr to search all tiles.
+	 */
+	inline void RestrictSearch(const std::vector<WaterRegionPatchDesc> *corridor)
+	{
+		m_water_region_corridor = corridor;
+	}
+
 	/**
 	 * Called by YAPF to move from the given node to the next tile. For each
 	 *  reachable trackdir on the new tile creates new node, initializes it
@@ -126,6 +165,10 @@ public:
 	{
 		TrackFollower F(Yapf().GetVehicle());
 		if (F.Follow(old_node.m_key.m_tile, old_node.m_key.m_td)) {
+			if (m_water_region_corridor != nullptr) {
+				const WaterRegionPatchDesc patch = GetWaterRegionPatchInfo(F.m_new_tile);
+				if (std::find(m_water_region_corridor->begin(), m_water_region_corridor->end(), patch) == m_water_region_corridor->end()) return;
+			}
 			Yapf().AddMultipleNodes(&old_node, F);
 		}
 	}
@@ -136,7 +179,7 @@ public:
 		return 'w';
 	}
 
-	static Trackdir ChooseShipTrack(const Ship *v, TileIndex tile, DiagDirection enterdir, TrackBits tracks, bool &path_found, ShipPathCache &path_cache)
+	static Trackdir ChooseShipTrack(const Ship *v, TileIndex tile, DiagDirection enterdir, TrackBits tracks, bool &path_found, ShipPathCache &path_cache, ShipDockingOccupancy *docking)
 	{
 		/* handle special case - when next tile is destination tile */
 		if (tile == v->dest_tile) {
@@ -158,14 +201,47 @@ public:
 		/* convert origin trackdir to TrackdirBits */
 		TrackdirBits trackdirs = TrackdirToTrackdirBits(trackdir);
 
+		if (_settings_game.pf.yapf.ship_water_regions) {
+			/* Find the water regions to pass first, then only search the tiles of the next few of them. */
+			bool reaches_destination;
+			std::vector<WaterRegionPatchDesc> corridor = YapfShipFindWaterRegionPath(v, src_tile, YAPF_SHIP_WATER_REGION_LOOKAHEAD + 1, reaches_destination);
+			if (!corridor.empty()) {
+				Tpf pf;
+				pf.SetDockingOccupancyLog(docking);
+				pf.SetOrigin(src_tile, trackdirs);
+				pf.SetDestination(v);
+				if (!reaches_destination) pf.SetIntermediateDestination(corridor.back());
+				pf.RestrictSearch(&corridor);
+				if (pf.FindPath(v)) {
+					path_found = true;
+					return FollowBestPath(pf, tile, path_found, path_cache);
+				}
+				/* Regions ignore some details of the tiles, e.g. which side of a depot can be entered. */
+			}
+		}
+
 		/* create pathfinder instance */
 		Tpf pf;
+		pf.SetDockingOccupancyLog(docking);
 		/* set origin and destination nodes */
 		pf.SetOrigin(src_tile, trackdirs);
 		pf.SetDestination(v);
 		/* find best path */
 		path_found = pf.FindPath(v);
 
+		return FollowBestPath(pf, tile, path_found, path_cache);
+	}
+
+	/**
+	 * Walk the best path found back to the origin.
+	 * @param pf The pathfinder that found the path.
+	 * @param tile The tile the ship is about to enter.
+	 * @param path_found Whether the path reaches the destination.
+	 * @param path_cache [out] The trackdirs to follow after the returned one.
+	 * @return The trackdir to take on \a tile, or INVALID_TRACKDIR if there is no path at all.
+	 */
+	static Trackdir FollowBestPath(Tpf &pf, TileIndex tile, bool path_found, ShipPathCache &path_cache)
+	{
 		Trackdir next_trackdir = INVALID_TRACKDIR; // this would mean "path not found"
 
 		Node *pNode = pf.GetBestNode();
@@ -253,6 +329,8 @@ public:
 	typedef typename Node::Key Key;               ///< key to hash tables
 
 protected:
+	ShipDockingOccupancy *m_docking_log = nullptr; ///< If not nullptr, log of the docking tiles whose occupancy was looked at.
+
 	/** to access inherited path finder */
 	Tpf& Yapf()
 	{
@@ -260,6 +338,15 @@ protected:
 	}
 
 public:
+	/**
+	 * Set where to log the docking tiles whose occupancy affects the costs.
+	 * @param docking_log The log, or nullptr to not log.
+	 */
+	inline void SetDockingOccupancyLog(ShipDockingOccupancy *docking_log)
+	{
+		m_docking_log = docking_log;
+	}
+
 	inline int CurveCost(Trackdir td1, Trackdir td2)
 	{
 		assert(IsValidTrackdir(td1));
@@ -301,6 +388,7 @@ public:
 			uint count = 0;
 			HasVehicleOnPos(n.GetTile(), &count, &CountShipProc);
 			c += count * 3 * YAPF_TILE_LENGTH;
+			if (m_docking_log != nullptr) m_docking_log->emplace_back(n.GetTile(), count);
 		}
 
 		/* Skipped tile cost for aqueducts. */
@@ -349,10 +437,10 @@ struct CYapfShip1 : CYapfT<CYapfShip_TypesT<CYapfShip1, CFollowTrackWater    , C
 struct CYapfShip2 : CYapfT<CYapfShip_TypesT<CYapfShip2, CFollowTrackWater    , CShipNodeListExitDir > > {};
 
 /** Ship controller helper - path finder invoker */
-Track YapfShipChooseTrack(const Ship *v, TileIndex tile, DiagDirection enterdir, TrackBits tracks, bool &path_found, ShipPathCache &path_cache)
+Track YapfShipChooseTrack(const Ship *v, TileIndex tile, DiagDirection enterdir, TrackBits tracks, bool &path_found, ShipPathCache &path_cache, ShipDockingOccupancy *docking)
 {
 	/* default is YAPF type 2 */
-	typedef Trackdir (*PfnChooseShipTrack)(const Ship*, TileIndex, DiagDirection, TrackBits, bool &path_found, ShipPathCache &path_cache);
+	typedef Trackdir (*PfnChooseShipTrack)(const Ship*, TileIndex, DiagDirection, TrackBits, bool &path_found, ShipPathCache &path_cache, ShipDockingOccupancy *docking);
 	PfnChooseShipTrack pfnChooseShipTrack = CYapfShip2::ChooseShipTrack; // default: ExitDir
 
 	/* check if non-default YAPF type needed */
@@ -360,10 +448,20 @@ Track YapfShipChooseTrack(const Ship *v, TileIndex tile, DiagDirection enterdir,
 		pfnChooseShipTrack = &CYapfShip1::ChooseShipTrack; // Trackdir
 	}
 
-	Trackdir td_ret = pfnChooseShipTrack(v, tile, enterdir, tracks, path_found, path_cache);
+	Trackdir td_ret = pfnChooseShipTrack(v, tile, enterdir, tracks, path_found, path_cache, docking);
 	return (td_ret != INVALID_TRACKDIR) ? TrackdirToTrack(td_ret) : INVALID_TRACK;
 }
 
+bool YapfShipDockingOccupancyUnchanged(const ShipDockingOccupancy &docking)
+{
+	for (const auto &it : docking) {
+		uint count = 0;
+		HasVehicleOnPos(it.first, &count, &CYapfShip2::CountShipProc);
+		if (count != it.second) return false;
+	}
+	return true;
+}
+
 bool YapfShipCheckReverse(const Ship *v, Trackdir *trackdir)
 {
 	Trackdir td = v->GetVehicleTrackdir();
@@ -0,0 +1,122 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file yapf_ship_regions.cpp Implementation of the high level ship pathfinder over water regions. */
+
+#include "../../stdafx.h"
+#include "../../station_base.h"
+#include "../../water_map.h"
+#include "../../settings_type.h"
+#include "yapf_ship_regions.h"
+
+#include <queue>
+#include <unordered_map>
+
+#include "../../safeguards.h"
+
+/** Node of the search through the water region patches. */
+struct WaterRegionNode {
+	WaterRegionPatchDesc patch; ///< The patch of the node.
+	int cost;                   ///< Number of regions from the node to the destination.
+	int parent;                 ///< Index of the next node towards the destination, or -1 for a destination patch.
+	bool closed;                ///< Whether the cost of the node is final.
+};
+
+/**
+ * Distance between the regions of two patches, in water regions.
+ * @param a The first patch.
+ * @param b The second patch.
+ * @return The manhattan distance.
+ */
+static inline int GetWaterRegionDistance(const WaterRegionPatchDesc &a, const WaterRegionPatchDesc &b)
+{
+	return Delta(a.x, b.x) + Delta(a.y, b.y);
+}
+
+/**
+ * Find the water region patches a ship passes on its way to its destination.
+ * The search runs from the destination patches towards the ship, so each
+ * found node knows its way to the destination. Ties are broken on the order
+ * the nodes were found in, which only depends on the map.
+ * @param v The ship.
+ * @param start_tile Tile the ship starts from.
+ * @param max_returned_path_length Maximum number of patches to return.
+ * @param[out] reaches_destination Whether the returned patches reach up to the destination.
+ * @return The patches from the one of \a start_tile onwards, or an empty vector when there is no path.
+ */
+std::vector<WaterRegionPatchDesc> YapfShipFindWaterRegionPath(const Ship *v, TileIndex start_tile, uint max_returned_path_length, bool &reaches_destination)
+{
+	reaches_destination = false;
+
+	const WaterRegionPatchDesc start = GetWaterRegionPatchInfo(start_tile);
+	if (start.label == INVALID_WATER_REGION_PATCH) return {};
+
+	typedef std::pair<int, uint> OpenEntry; ///< Estimate and index of an open node.
+	std::priority_queue<OpenEntry, std::vector<OpenEntry>, std::greater<OpenEntry>> open;
+	std::vector<WaterRegionNode> nodes;
+	std::unordered_map<uint32, uint> node_indices;
+
+	auto add_node = [&](const WaterRegionPatchDesc &patch, int cost, int parent) {
+		auto it = node_indices.find(GetWaterRegionPatchKey(patch));
+		if (it != node_indices.end()) {
+			WaterRegionNode &node = nodes[it->second];
+			if (node.closed || node.cost <= cost) return;
+			/* The old entry in the open list is skipped once the node is closed. */
+			node.cost = cost;
+			node.parent = parent;
+			open.emplace(cost + GetWaterRegionDistance(patch, start), it->second);
+			return;
+		}
+		node_indices[GetWaterRegionPatchKey(patch)] = (uint)nodes.size();
+		open.emplace(cost + GetWaterRegionDistance(patch, start), (uint)nodes.size());
+		nodes.push_back({patch, cost, parent, false});
+	};
+
+	/* Same destination as the tile level search, see CYapfDestinationTileWaterT. */
+	if (v->current_order.IsType(OT_GOTO_STATION)) {
+		const Station *st = Station::GetIfValid(v->current_order.GetDestination());
+		if (st == nullptr) return {};
+		for (TileIndex tile : st->docking_station) {
+			if (!IsDockingTile(tile) || !IsShipDestinationTile(tile, st->index)) continue;
+			WaterRegionPatchDesc patch = GetWaterRegionPatchInfo(tile);
+			if (patch.label != INVALID_WATER_REGION_PATCH) add_node(patch, 0, -1);
+		}
+	} else {
+		if (v->dest_tile >= MapSize()) return {};
+		WaterRegionPatchDesc patch = GetWaterRegionPatchInfo(v->dest_tile);
+		if (patch.label != INVALID_WATER_REGION_PATCH) add_node(patch, 0, -1);
+	}
+
+	const uint max_nodes = _settings_game.pf.yapf.max_search_nodes;
+	while (!open.empty()) {
+		uint index = open.top().second;
+		open.pop();
+		if (nodes[index].closed) continue;
+		nodes[index].closed = true;
+
+		if (nodes[index].patch == start) {
+			std::vector<WaterRegionPatchDesc> path;
+			for (int i = index; i >= 0 && path.size() < max_returned_path_length; i = nodes[i].parent) {
+				path.push_back(nodes[i].patch);
+				if (nodes[i].parent < 0) reaches_destination = true;
+			}
+			return path;
+		}
+
+		if (nodes.size() >= max_nodes) break;
+
+		/* Adding nodes may move them, so copy what is needed. */
+		const WaterRegionPatchDesc patch = nodes[index].patch;
+		const int cost = nodes[index].cost;
+		VisitWaterRegionPatchNeighbours(patch, [&](const WaterRegionPatchDesc &neighbour) {
+			/* Aqueducts may skip regions. */
+			add_node(neighbour, cost + std::max(1, GetWaterRegionDistance(patch, neighbour)), index);
+		});
+	}
+
+	return {};
+}
@@ -13,8 +13,67 @@
 #include "newgrf_station.h"
 #include "pathfinder/follow_track.hpp"
 
+#include <unordered_map>
+
 #include "safeguards.h"
 
+/** Start of a reservation to follow, and how it is followed. */
+struct ReservationIndexKey {
+	TileIndex tile;
+	Trackdir  trackdir;
+	Owner     owner;
+	RailTypes rts;
+	bool      ignore_oneway;
+
+	inline bool operator==(const ReservationIndexKey &other) const
+	{
+		return this->tile == other.tile && this->trackdir == other.trackdir && this->owner == other.owner
+			&& this->rts == other.rts && this->ignore_oneway == other.ignore_oneway;
+	}
+
+	/** Hash function for the reservation index. */
+	struct Hash {
+		inline size_t operator()(const ReservationIndexKey &key) const
+		{
+			return (static_cast<size_t>(key.tile) << 4 | key.trackdir) ^ (static_cast<size_t>(key.owner) << 28) ^ (key.ignore_oneway ? 0x8 : 0);
+		}
+	};
+};
+
+/** End of a followed reservation. */
+struct ReservationIndexEntry {
+	PBSTileInfo end;   ///< Where the reservation ends.
+	uint64 generation; ///< Value of #_reservation_index_generation when the end was found.
+};
+
+static const size_t RESERVATION_INDEX_MAX_SIZE = 1 << 16; ///< Number of entries at which the outdated ones are thrown away.
+
+/**
+ * The ends of followed reservations. Only the entries found since the last
+ * change of any reservation or of the track layout are used; the map setters
+ * of both call #InvalidateReservationIndex, so the used entries always tell
+ * where a reservation leads. The trains on the ends are still looked up each time.
+ */
+static std::unordered_map<ReservationIndexKey, ReservationIndexEntry, ReservationIndexKey::Hash> _reservation_index;
+static uint64 _reservation_index_generation = 0; ///< Generation of the entries of #_reservation_index that are up to date.
+
+/** Forget the ends of all reservations; a reservation or the track layout changed. */
+void InvalidateReservationIndex()
+{
+	_reservation_index_generation++;
+}
+
+/**
+ * Remember where a reservation ends.
+ * @param key Position on the reservation, and how it is followed.
+ * @param end End of the reservation.
+ */
+static void AddToReservationIndex(const ReservationIndexKey &key, const PBSTileInfo &end)
+{
+	if (_reservation_index.size() >= RESERVATION_INDEX_MAX_SIZE) _reservation_index.clear();
+	_reservation_index[key] = {end, _reservation_index_generation};
+}
+
 /**
  * Get the reserved trackbits for any tile, regardless of type.
  * @param t the tile
@@ -183,9 +242,27 @@ void UnreserveRailTrack(TileIndex tile, Track t)
 }
 
 
-/** Follow a reservation starting from a specific tile to the end. */
-static PBSTileInfo FollowReservation(Owner o, RailTypes rts, TileIndex tile, Trackdir trackdir, bool ignore_oneway = false)
+/**
+ * Follow a reservation starting from a specific tile to the end.
+ * @param o Owner of the tracks that may be followed.
+ * @param rts Rail types that may be followed.
+ * @param tile Tile to start at.
+ * @param trackdir Trackdir to start at.
+ * @param ignore_oneway Whether to pass one-way signals against the direction.
+ * @param index_path Whether to add every position passed to the index, for further queries along the reservation.
+ * @return The end of the reservation.
+ */
+static PBSTileInfo FollowReservation(Owner o, RailTypes rts, TileIndex tile, Trackdir trackdir, bool ignore_oneway = false, bool index_path = false)
 {
+	ReservationIndexKey key = {tile, trackdir, o, rts, ignore_oneway};
+	auto it = _reservation_index.find(key);
+	if (it != _reservation_index.end() && it->second.generation == _reservation_index_generation) return it->second.end;
+
+	/* Positions the search went on from. Following from any of them leads to the
+	 * same end, unless the reservation loops back to where the search started. */
+	std::vector<std::pair<TileIndex, Trackdir>> passed;
+	bool looped = false;
+
 	TileIndex start_tile = tile;
 	Trackdir  start_trackdir = trackdir;
 	bool      first_loop = true;
@@ -193,7 +270,11 @@ static PBSTileInfo FollowReservation(Owner o, RailTypes rts, TileIndex tile, Tra
 	/* Start track not reserved? This can happen if two trains
 	 * are on the same tile. The reservation on the next tile
 	 * is not ours in this case, so exit. */
-	if (!HasReservedTracks(tile, TrackToTrackBits(TrackdirToTrack(trackdir)))) return PBSTileInfo(tile, trackdir, false);
+	if (!HasReservedTracks(tile, TrackToTrackBits(TrackdirToTrack(trackdir)))) {
+		PBSTileInfo end(tile, trackdir, false);
+		AddToReservationIndex(key, end);
+		return end;
+	}
 
 	/* Do not disallow 90 deg turns as the setting might have changed between reserving and now. */
 	CFollowTrackRail ft(o, rts);
@@ -237,15 +318,25 @@ static PBSTileInfo FollowReservation(Owner o, RailTypes rts, TileIndex tile, Tra
 			first_loop = false;
 		} else {
 			/* Loop encountered? */
-			if (tile == start_tile && trackdir == start_trackdir) break;
+			if (tile == start_tile && trackdir == start_trackdir) {
+				looped = true;
+				break;
+			}
 		}
 		/* Depot tile? Can't continue. */
 		if (IsRailDepotTile(tile)) break;
 		/* Non-pbs signal? Reservation can't continue. */
 		if (IsTileType(tile, MP_RAILWAY) && HasSignalOnTrackdir(tile, trackdir) && !IsPbsSignal(GetSignalType(tile, TrackdirToTrack(trackdir)))) break;
+
+		if (index_path) passed.emplace_back(tile, trackdir);
 	}
 
-	return PBSTileInfo(tile, trackdir, false);
+	PBSTileInfo end(tile, trackdir, false);
+	AddToReservationIndex(key, end);
+	if (!looped) {
+		for (const auto &pos : passed) AddToReservationIndex({pos.first, pos.second, o, rts, ignore_oneway}, end);
+	}
+	return end;
 }
 
 /**
@@ -343,7 +434,7 @@ Train *GetTrainForReservation(TileIndex tile, Track track)
 		if (HasOnewaySignalBlockingTrackdir(tile, ReverseTrackdir(trackdir)) && !HasPbsSignalOnTrackdir(tile, trackdir)) continue;
 
 		FindTrainOnTrackInfo ftoti;
-		ftoti.res = FollowReservation(GetTileOwner(tile), rts, tile, trackdir, true);
+		ftoti.res = FollowReservation(GetTileOwner(tile), rts, tile, trackdir, true, true);
 
 		FindVehicleOnPos(ftoti.res.tile, &ftoti, FindTrainOnTrackEnum);
 		if (ftoti.best != nullptr) return ftoti.best;
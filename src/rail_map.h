@@ -84,6 +84,8 @@ static inline void SetHasSignals(TileIndex tile, bool signals)
 {
 	assert(IsPlainRailTile(tile));
 	SB(_m[tile].m5, 6, 1, signals);
+	InvalidateSignalBlocks(tile);
+	InvalidateReservationIndex();
 }
 
 /**
@@ -125,6 +127,7 @@ static inline RailType GetRailType(TileIndex t)
 static inline void SetRailType(TileIndex t, RailType r)
 {
 	SB(_me[t].m8, 0, 6, r);
+	InvalidateReservationIndex();
 }
 
 
@@ -148,6 +151,8 @@ static inline void SetTrackBits(TileIndex t, TrackBits b)
 {
 	assert(IsPlainRailTile(t));
 	SB(_m[t].m5, 0, 6, b);
+	InvalidateSignalBlocks(t);
+	InvalidateReservationIndex();
 }
 
 /**
@@ -214,6 +219,7 @@ static inline void SetTrackReservation(TileIndex t, TrackBits b)
 	Track track = RemoveFirstTrack(&b);
 	SB(_m[t].m2, 8, 3, track == INVALID_TRACK ? 0 : track + 1);
 	SB(_m[t].m2, 11, 1, (byte)(b != TRACK_BIT_NONE));
+	InvalidateReservationIndex();
 }
 
 /**
@@ -271,6 +277,7 @@ static inline void SetDepotReservation(TileIndex t, bool b)
 {
 	assert(IsRailDepot(t));
 	SB(_m[t].m5, 4, 1, (byte)b);
+	InvalidateReservationIndex();
 }
 
 /**
@@ -303,6 +310,8 @@ static inline void SetSignalType(TileIndex t, Track track, SignalType s)
 	byte pos = (track == TRACK_LOWER || track == TRACK_RIGHT) ? 4 : 0;
 	SB(_m[t].m2, pos, 3, s);
 	if (track == INVALID_TRACK) SB(_m[t].m2, 4, 3, s);
+	InvalidateSignalBlocks(t);
+	InvalidateReservationIndex();
 }
 
 static inline bool IsPresignalEntry(TileIndex t, Track track)
@@ -329,6 +338,8 @@ static inline void CycleSignalSide(TileIndex t, Track track)
 	sig = GB(_m[t].m3, pos, 2);
 	if (--sig == 0) sig = IsPbsSignal(GetSignalType(t, track)) ? 2 : 3;
 	SB(_m[t].m3, pos, 2, sig);
+	InvalidateSignalBlocks(t);
+	InvalidateReservationIndex();
 }
 
 static inline SignalVariant GetSignalVariant(TileIndex t, Track track)
@@ -383,6 +394,8 @@ static inline SignalState GetSingleSignalState(TileIndex t, byte signalbit)
 static inline void SetPresentSignals(TileIndex tile, uint signals)
 {
 	SB(_m[tile].m3, 4, 4, signals);
+	InvalidateSignalBlocks(tile);
+	InvalidateReservationIndex();
 }
 
 /**
@@ -18,6 +18,7 @@
 #include "road_map.h"
 #include "newgrf_engine.h"
 #include <deque>
+#include <tuple>
 
 struct RoadVehicle;
 
@@ -101,6 +102,31 @@ struct RoadVehPathCache {
 	}
 };
 
+/** Road stop tiles looked at by a road vehicle pathfinder search, with the trackdir they were passed in and their occupancy cost. */
+typedef std::vector<std::tuple<TileIndex, Trackdir, int>> RoadVehStopOccupancy;
+
+/**
+ * Pathfinder decision for the tile a road vehicle is about to enter, made
+ * before the vehicle ticks by #PlanRoadVehPath. It is only used when the
+ * vehicle is really choosing a trackdir on that tile in the same round of
+ * vehicle ticks, and everything the search depended on is still the same.
+ */
+struct RoadVehPathPlan {
+	uint32 round;                   ///< Round of vehicle ticks the plan was made for, see #_vehicle_plan_round.
+	TileIndex tile;                 ///< Tile the vehicle is expected to enter.
+	DiagDirection enterdir;         ///< Direction the vehicle is expected to enter the tile from.
+	TrackdirBits trackdirs;         ///< Trackdirs that were available on the tile.
+	TileIndex origin;               ///< Tile of the vehicle when planning.
+	TileIndex dest_tile;            ///< Destination of the vehicle when planning.
+	OrderType order_type;           ///< Type of the current order when planning.
+	DestinationID order_dest;       ///< Destination of the current order when planning.
+	uint16 order_max_speed;         ///< Maximum speed of the current order when planning.
+	Trackdir trackdir;              ///< The trackdir chosen by the pathfinder.
+	bool path_found;                ///< Whether the pathfinder found a path.
+	RoadVehPathCache path;          ///< The path cache filled by the pathfinder.
+	RoadVehStopOccupancy occupancy; ///< The road stops the pathfinder looked at.
+};
+
 /**
  * Buses, trucks and trams belong to this class.
  */
@@ -116,6 +142,7 @@ struct RoadVehicle FINAL : public GroundVehicle<RoadVehicle, VEH_ROAD> {
 
 	RoadType roadtype;              //!< Roadtype of this vehicle.
 	RoadTypes compatible_roadtypes; //!< Roadtypes this consist is powered on.
+	RoadVehPathPlan plan;           ///< NOSAVE: Pathfinder decision made ahead of the vehicle tick.
 
 	/** We don't want GCC to zero our struct! It already is zeroed and has an index! */
 	RoadVehicle() : GroundVehicleBase() {}
@@ -325,4 +352,7 @@ protected: // These functions should not be called outside acceleration code.
 	}
 };
 
+bool CanPlanRoadVehPath(const RoadVehicle *v);
+void PlanRoadVehPath(RoadVehicle *v, uint32 round);
+
 #endif /* ROADVEH_H */
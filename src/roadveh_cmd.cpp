@@ -870,23 +870,17 @@ static int PickRandomBit(uint bits)
 }
 
 /**
- * Returns direction to for a road vehicle to take or
- * INVALID_TRACKDIR if the direction is currently blocked
- * @param v        the Vehicle to do the pathfinding for
- * @param tile     the where to start the pathfinding
- * @param enterdir the direction the vehicle enters the tile from
- * @return the Trackdir to take
+ * Get the trackdirs a road vehicle can take on the tile it is about to enter.
+ * @param v           the Vehicle entering the tile
+ * @param tile        the tile
+ * @param enterdir    the direction the vehicle enters the tile from
+ * @param red_signals [out] the trackdirs that are closed, i.e. at a level crossing
+ * @return the trackdirs reachable from \a enterdir
  */
-static Trackdir RoadFindPathToDest(RoadVehicle *v, TileIndex tile, DiagDirection enterdir)
+static TrackdirBits GetRoadVehTrackdirs(const RoadVehicle *v, TileIndex tile, DiagDirection enterdir, TrackdirBits &red_signals)
 {
-#define return_track(x) { best_track = (Trackdir)x; goto found_best_track; }
-
-	TileIndex desttile;
-	Trackdir best_track;
-	bool path_found = true;
-
 	TrackStatus ts = GetTileTrackStatus(tile, TRANSPORT_ROAD, GetRoadTramType(v->roadtype));
-	TrackdirBits red_signals = TrackStatusToRedSignals(ts); // crossing
+	red_signals = TrackStatusToRedSignals(ts); // crossing
 	TrackdirBits trackdirs = TrackStatusToTrackdirBits(ts);
 
 	if (IsTileType(tile, MP_ROAD)) {
@@ -923,7 +917,74 @@ static Trackdir RoadFindPathToDest(RoadVehicle *v, TileIndex tile, DiagDirection
 	 */
 
 	/* Remove tracks unreachable from the enter dir */
-	trackdirs &= DiagdirReachesTrackdirs(enterdir);
+	return trackdirs & DiagdirReachesTrackdirs(enterdir);
+}
+
+/**
+ * Check whether a road vehicle might have to use the pathfinder during its
+ * next tick, so it is worth to plan its path ahead; see #PlanRoadVehPath.
+ * @param v The road vehicle.
+ * @return True if the path of the vehicle should be planned.
+ */
+bool CanPlanRoadVehPath(const RoadVehicle *v)
+{
+	if (_settings_game.pf.pathfinder_for_roadvehs != VPF_YAPF || !v->IsFrontEngine()) return false;
+	if ((v->vehstatus & (VS_STOPPED | VS_CRASHED | VS_HIDDEN)) != 0 || v->breakdown_ctr != 0) return false;
+	if (v->dest_tile == 0 || !v->path.empty() || v->reverse_ctr != 0 || v->current_order.IsType(OT_LOADING)) return false;
+	/* Only vehicles simply driving along the road, not in road stops, depots, tunnels or while overtaking or turning. */
+	return v->state <= RVSB_TRACKDIR_MASK && !IsReversingRoadTrackdir((Trackdir)v->state) && v->overtaking == 0;
+}
+
+/**
+ * Try to use the planned path of a road vehicle, instead of running the pathfinder.
+ * The plan is only used when the pathfinder would now come to the same
+ * result, i.e. when everything it depended on did not change since planning.
+ * @param v The road vehicle.
+ * @param tile The tile the vehicle is about to enter.
+ * @param enterdir The direction the vehicle enters the tile from.
+ * @param trackdirs The available trackdirs on the tile.
+ * @param[out] trackdir The planned trackdir.
+ * @param[out] path_found Whether the pathfinder found a path.
+ * @return True if the plan could be used.
+ */
+static bool UsePlannedRoadVehPath(RoadVehicle *v, TileIndex tile, DiagDirection enterdir, TrackdirBits trackdirs, Trackdir &trackdir, bool &path_found)
+{
+	RoadVehPathPlan &plan = v->plan;
+	if (plan.round != _vehicle_plan_round) return false;
+
+	/* A plan is only good for one try. */
+	plan.round = 0;
+
+	if (plan.tile != tile || plan.enterdir != enterdir || plan.trackdirs != trackdirs) return false;
+	if (plan.origin != v->tile || plan.dest_tile != v->dest_tile) return false;
+	if (plan.order_type != v->current_order.GetType() || plan.order_dest != v->current_order.GetDestination()) return false;
+	if (plan.order_max_speed != v->current_order.GetMaxSpeed()) return false;
+	if (!YapfRoadStopOccupancyUnchanged(plan.occupancy)) return false;
+
+	trackdir = plan.trackdir;
+	path_found = plan.path_found;
+	std::swap(v->path, plan.path);
+	return true;
+}
+
+/**
+ * Returns direction to for a road vehicle to take or
+ * INVALID_TRACKDIR if the direction is currently blocked
+ * @param v        the Vehicle to do the pathfinding for
+ * @param tile     the where to start the pathfinding
+ * @param enterdir the direction the vehicle enters the tile from
+ * @return the Trackdir to take
+ */
+static Trackdir RoadFindPathToDest(RoadVehicle *v, TileIndex tile, DiagDirection enterdir)
+{
+#define return_track(x) { best_track = (Trackdir)x; goto found_best_track; }
+
+	TileIndex desttile;
+	Trackdir best_track;
+	bool path_found = true;
+
+	TrackdirBits red_signals;
+	TrackdirBits trackdirs = GetRoadVehTrackdirs(v, tile, enterdir, red_signals);
 	if (trackdirs == TRACKDIR_BIT_NONE) {
 		/* If vehicle expected a path, it no longer exists, so invalidate it. */
 		if (!v->path.empty()) v->path.clear();
@@ -985,7 +1046,11 @@ static Trackdir RoadFindPathToDest(RoadVehicle *v, TileIndex tile, DiagDirection
 
 	switch (_settings_game.pf.pathfinder_for_roadvehs) {
 		case VPF_NPF:  best_track = NPFRoadVehicleChooseTrack(v, tile, enterdir, path_found); break;
-		case VPF_YAPF: best_track = YapfRoadVehicleChooseTrack(v, tile, enterdir, trackdirs, path_found, v->path); break;
+		case VPF_YAPF:
+			if (!UsePlannedRoadVehPath(v, tile, enterdir, trackdirs, best_track, path_found)) {
+				best_track = YapfRoadVehicleChooseTrack(v, tile, enterdir, trackdirs, path_found, v->path);
+			}
+			break;
 
 		default: NOT_REACHED();
 	}
@@ -1004,6 +1069,51 @@ struct RoadDriveEntry {
 
 #include "table/roadveh_movement.h"
 
+/**
+ * Ask the pathfinder which trackdir a road vehicle should take on the tile
+ * it is about to enter, assuming it keeps driving as it does now. This is
+ * called on a worker thread before the vehicle ticks, while nothing changes
+ * the game state; so it may only read the game state and write the plan of
+ * this vehicle.
+ * @param v The road vehicle.
+ * @param round The round of vehicle ticks to plan for.
+ */
+void PlanRoadVehPath(RoadVehicle *v, uint32 round)
+{
+	RoadVehPathPlan &plan = v->plan;
+
+	/* Only plan when the vehicle can reach the next tile during its next tick, see IndividualRoadVehicleController. */
+	uint steps = (v->GetAdvanceSpeed(v->vcache.cached_max_speed) + v->progress) / v->GetAdvanceDistance();
+	const RoadDriveEntry *rd = _road_drive_data[GetRoadTramType(v->roadtype)][v->state + (_settings_game.vehicle.road_side << RVS_DRIVE_SIDE)];
+	uint frame = v->frame + 1;
+	while ((rd[frame].x & RDE_NEXT_TILE) == 0) {
+		if ((rd[frame].x & RDE_TURNED) != 0 || frame - v->frame >= steps) return;
+		frame++;
+	}
+
+	DiagDirection enterdir = (DiagDirection)(rd[frame].x & 3);
+	TileIndex tile = v->tile + TileOffsByDiagDir(enterdir);
+	if (!HasTileAnyRoadType(tile, v->compatible_roadtypes)) return;
+
+	/* The pathfinder is only asked when there is a choice, see RoadFindPathToDest. */
+	TrackdirBits red_signals;
+	TrackdirBits trackdirs = GetRoadVehTrackdirs(v, tile, enterdir, red_signals);
+	if (KillFirstBit(trackdirs) == TRACKDIR_BIT_NONE) return;
+
+	plan.tile = tile;
+	plan.enterdir = enterdir;
+	plan.trackdirs = trackdirs;
+	plan.origin = v->tile;
+	plan.dest_tile = v->dest_tile;
+	plan.order_type = v->current_order.GetType();
+	plan.order_dest = v->current_order.GetDestination();
+	plan.order_max_speed = v->current_order.GetMaxSpeed();
+	plan.path.clear();
+	plan.occupancy.clear();
+	plan.trackdir = YapfRoadVehicleChooseTrack(v, tile, enterdir, trackdirs, plan.path_found, plan.path, &plan.occupancy);
+	plan.round = round;
+}
+
 bool RoadVehLeaveDepot(RoadVehicle *v, bool first)
 {
 	/* Don't leave unless v and following wagons are in the depot. */
@@ -27,6 +27,7 @@
 #include "../roadveh_cmd.h"
 #include "../train.h"
 #include "../station_base.h"
+#include "../station_func.h"
 #include "../waypoint_base.h"
 #include "../roadstop_base.h"
 #include "../tunnelbridge_map.h"
@@ -2200,6 +2201,9 @@ bool AfterLoadGame()
 		}
 	}
 
+	/* The animated tile table has been loaded without its index. */
+	RebuildAnimatedTileIndex();
+
 	if (IsSavegameVersionBefore(SLV_124) && !IsSavegameVersionBefore(SLV_1)) {
 		/* The train station tile area was added, but for really old (TTDPatch) it's already valid. */
 		for (Waypoint *wp : Waypoint::Iterate()) {
@@ -3200,6 +3204,9 @@ bool AfterLoadGame()
 	/* Compute station catchment areas. This is needed here in case UpdateStationAcceptance is called below. */
 	Station::RecomputeCatchmentForAll();
 
+	/* The rating schedule is not saved; it is rebuilt from the rating countdowns. */
+	RebuildStationRatingSchedule();
+
 	/* Station acceptance is some kind of cache */
 	if (IsSavegameVersionBefore(SLV_127)) {
 		for (Station *st : Station::Iterate()) UpdateStationAcceptance(st, false);
@@ -3212,6 +3219,9 @@ bool AfterLoadGame()
 	GamelogPrintDebug(1);
 
 	InitializeWindowsAndCaches();
+	/* The map was converted without telling the signal blocks or the reservation index. */
+	InvalidateAllSignalBlocks();
+	InvalidateReservationIndex();
 	/* Restore the signals */
 	ResetSignalHandlers();
 
@@ -3261,6 +3271,8 @@ void ReloadNewGRFData()
 	AfterLoadCompanyStats();
 	/* Check and update house and town values */
 	UpdateHousesAndTowns();
+	/* Houses and industry tiles may accept other cargo now */
+	for (Station *st : Station::Iterate()) st->catchment_acceptance_valid = false;
 	/* Delete news referring to no longer existing entities */
 	DeleteInvalidEngineNews();
 	/* Update livery selection windows */
@@ -13,6 +13,7 @@
 #include "compat/animated_tile_sl_compat.h"
 
 #include "../tile_type.h"
+#include "../animated_tile_func.h"
 #include "../core/alloc_func.hpp"
 #include "../core/smallvec_type.hpp"
 
@@ -24,15 +25,28 @@ static const SaveLoad _animated_tile_desc[] = {
 	 SLEG_VECTOR("tiles", _animated_tiles, SLE_UINT32),
 };
 
+/** The animated tile table without the entries of deleted tiles, as it is saved. */
+static std::vector<TileIndex> _animated_tiles_to_save;
+
+static const SaveLoad _animated_tile_save_desc[] = {
+	 SLEG_VECTOR("tiles", _animated_tiles_to_save, SLE_UINT32),
+};
+
 struct ANITChunkHandler : ChunkHandler {
 	ANITChunkHandler() : ChunkHandler('ANIT', CH_TABLE) {}
 
 	void Save() const override
 	{
-		SlTableHeader(_animated_tile_desc);
+		/* Do not save the tiles that were deleted, but are still in the table.
+		 * The table itself is left alone, as saving must not change the game state. */
+		_animated_tiles_to_save.clear();
+		std::copy_if(_animated_tiles.begin(), _animated_tiles.end(), std::back_inserter(_animated_tiles_to_save), [](TileIndex tile) { return tile != INVALID_TILE; });
+
+		SlTableHeader(_animated_tile_save_desc);
 
 		SlSetArrayIndex(0);
-		SlGlobList(_animated_tile_desc);
+		SlGlobList(_animated_tile_save_desc);
+		_animated_tiles_to_save.clear();
 	}
 
 	void Load() const override
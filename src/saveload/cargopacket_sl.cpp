@@ -55,6 +55,7 @@
 				}
 			}
 		}
+		StationCargoList::InvalidateMergeIndices();
 	}
 
 	if (IsSavegameVersionBefore(SLV_120)) {
@@ -344,6 +344,8 @@ enum SaveLoadVersion : uint16 {
 	SLV_U64_TICK_COUNTER,                   ///< 300  PR#10035 Make _tick_counter 64bit to avoid wrapping.
 	SLV_LAST_LOADING_TICK,                  ///< 301  PR#9693 Store tick of last loading for vehicles.
 	SLV_MULTITRACK_LEVEL_CROSSINGS,         ///< 302  PR#9931 v13.0  Multi-track level crossings.
+	SLV_BATCHED_TILE_LOOP,                  ///< 303  Setting to run the tile loop grouped by tile type; the setting has been removed again.
+	SLV_SHIP_WATER_REGIONS,                 ///< 304  Setting to let ships search water regions before tiles.
 
 	SL_MAX_VERSION,                         ///< Highest possible saveload version
 };
@@ -391,7 +393,9 @@ void DoExitSave();
 
 void DoAutoOrNetsave(FiosNumberedSaveName &counter);
 
-SaveOrLoadResult SaveWithFilter(struct SaveFilter *writer, bool threaded);
+SaveOrLoadResult SaveWithFilter(struct SaveFilter *writer, bool threaded, const std::string &format);
+std::vector<uint32> GetLoadableSavegameFormats();
+std::string GetSavegameFormatLoadableBy(const std::string &format, const std::vector<uint32> &loadable);
 SaveOrLoadResult LoadWithFilter(struct LoadFilter *reader);
 
 typedef void AutolengthProc(void *arg);
@@ -1150,6 +1154,8 @@ static inline void SlSkipBytes(size_t length)
 }
 
 extern std::string _savegame_format;
+extern std::string _network_savegame_format;
+extern uint8 _savegame_zstd_threads;
 extern bool _do_autosave;
 
 #endif /* SAVELOAD_H */
@@ -13,6 +13,7 @@
 #include "compat/station_sl_compat.h"
 
 #include "../station_base.h"
+#include "../station_func.h"
 #include "../waypoint_base.h"
 #include "../roadstop_base.h"
 #include "../vehicle_base.h"
@@ -181,15 +182,17 @@ static void SwapPackets(GoodsEntry *ge)
 	StationCargoPacketMap &ge_packets = const_cast<StationCargoPacketMap &>(*ge->cargo.Packets());
 
 	if (_packets.empty()) {
-		std::map<StationID, std::list<CargoPacket *> >::iterator it(ge_packets.find(INVALID_STATION));
+		StationCargoPacketMap::MapIterator it(ge_packets.find(INVALID_STATION));
 		if (it == ge_packets.end()) {
 			return;
 		} else {
-			it->second.swap(_packets);
+			_packets.assign(it->second.begin(), it->second.end());
+			it->second.clear();
 		}
 	} else {
 		assert(ge_packets[INVALID_STATION].empty());
-		ge_packets[INVALID_STATION].swap(_packets);
+		ge_packets[INVALID_STATION].assign(_packets.begin(), _packets.end());
+		_packets.clear();
 	}
 }
 
@@ -236,7 +239,8 @@ public:
 	{
 		SlSetStructListLength(ge->cargo.Packets()->MapSize());
 		for (StationCargoPacketMap::ConstMapIterator it(ge->cargo.Packets()->begin()); it != ge->cargo.Packets()->end(); ++it) {
-			SlObject(const_cast<StationCargoPacketMap::value_type *>(&(*it)), this->GetDescription());
+			StationCargoPair pair(it->first, std::list<CargoPacket *>(it->second.begin(), it->second.end()));
+			SlObject(&pair, this->GetDescription());
 		}
 	}
 
@@ -247,15 +251,18 @@ public:
 		StationCargoPair pair;
 		for (uint j = 0; j < num_dests; ++j) {
 			SlObject(&pair, this->GetLoadDescription());
-			const_cast<StationCargoPacketMap &>(*(ge->cargo.Packets()))[pair.first].swap(pair.second);
-			assert(pair.second.empty());
+			const_cast<StationCargoPacketMap &>(*(ge->cargo.Packets()))[pair.first].assign(pair.second.begin(), pair.second.end());
+			pair.second.clear();
 		}
 	}
 
 	void FixPointers(GoodsEntry *ge) const override
 	{
-		for (StationCargoPacketMap::ConstMapIterator it = ge->cargo.Packets()->begin(); it != ge->cargo.Packets()->end(); ++it) {
-			SlObject(const_cast<StationCargoPair *>(&(*it)), this->GetDescription());
+		StationCargoPacketMap &packets = const_cast<StationCargoPacketMap &>(*ge->cargo.Packets());
+		for (StationCargoPacketMap::MapIterator it = packets.begin(); it != packets.end(); ++it) {
+			StationCargoPair pair(it->first, std::list<CargoPacket *>(it->second.begin(), it->second.end()));
+			SlObject(&pair, this->GetDescription());
+			it->second.assign(pair.second.begin(), pair.second.end());
 		}
 	}
 };
@@ -661,6 +668,8 @@ struct STNNChunkHandler : ChunkHandler {
 	{
 		SlTableHeader(_station_desc);
 
+		StoreStationRatingCounters();
+
 		/* Write the stations */
 		for (BaseStation *st : BaseStation::Iterate()) {
 			SlSetArrayIndex(st->index);
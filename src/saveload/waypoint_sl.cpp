@@ -11,7 +11,7 @@
 #include "../waypoint_base.h"
 #include "../debug.h"
 #include "../newgrf_station.h"
-#include "../vehicle_base.h"
+#include "../train.h"
 #include "../town.h"
 #include "../newgrf.h"
 
@@ -149,9 +149,7 @@ void MoveWaypointsToBaseStations()
 		for (Order *o = ol->GetFirstOrder(); o != nullptr; o = o->next) UpdateWaypointOrder(o);
 	}
 
-	for (Vehicle *v : Vehicle::Iterate()) {
-		if (v->type != VEH_TRAIN) continue;
-
+	for (Train *v : Train::Iterate()) {
 		UpdateWaypointOrder(&v->current_order);
 	}
 
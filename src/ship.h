@@ -19,6 +19,30 @@ void GetShipSpriteSize(EngineID engine, uint &width, uint &height, int &xoffs, i
 WaterClass GetEffectiveWaterClass(TileIndex tile);
 
 typedef std::deque<Trackdir> ShipPathCache;
+/** Docking tiles looked at by a ship pathfinder search, with the number of ships that were on them. */
+typedef std::vector<std::pair<TileIndex, uint>> ShipDockingOccupancy;
+
+/**
+ * Pathfinder decision for the tile a ship is about to enter, made before the
+ * vehicle ticks by #PlanShipTrack. It is only used when the ship is really
+ * choosing a track on that tile in the same round of vehicle ticks, and
+ * everything the search depended on is still the same.
+ */
+struct ShipTrackPlan {
+	uint32 round;                  ///< Round of vehicle ticks the plan was made for, see #_vehicle_plan_round.
+	TileIndex tile;                ///< Tile the ship is expected to enter.
+	DiagDirection enterdir;        ///< Direction the ship is expected to enter the tile from.
+	TrackBits tracks;              ///< Tracks that were available on the tile.
+	TileIndex origin;              ///< Tile of the ship when planning.
+	Trackdir trackdir;             ///< Trackdir of the ship when planning.
+	TileIndex dest_tile;           ///< Destination of the ship when planning.
+	OrderType order_type;          ///< Type of the current order when planning.
+	DestinationID order_dest;      ///< Destination of the current order when planning.
+	Track track;                   ///< The track chosen by the pathfinder.
+	bool path_found;               ///< Whether the pathfinder found a path.
+	ShipPathCache path;            ///< The path cache filled by the pathfinder.
+	ShipDockingOccupancy docking;  ///< The docking tiles the pathfinder looked at.
+};
 
 /**
  * All ships have this type.
@@ -29,6 +53,7 @@ struct Ship FINAL : public SpecializedVehicle<Ship, VEH_SHIP> {
 	Direction rotation;   ///< Visible direction.
 	int16 rotation_x_pos; ///< NOSAVE: X Position before rotation.
 	int16 rotation_y_pos; ///< NOSAVE: Y Position before rotation.
+	ShipTrackPlan plan;   ///< NOSAVE: Pathfinder decision made ahead of the vehicle tick.
 
 	/** We don't want GCC to zero our struct! It already is zeroed and has an index! */
 	Ship() : SpecializedVehicleBase() {}
@@ -56,5 +81,7 @@ struct Ship FINAL : public SpecializedVehicle<Ship, VEH_SHIP> {
 };
 
 bool IsShipDestinationTile(TileIndex tile, StationID station);
+bool CanPlanShipTrack(const Ship *v);
+void PlanShipTrack(Ship *v, uint32 round);
 
 #endif /* SHIP_H */
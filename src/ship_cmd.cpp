@@ -142,6 +142,31 @@ void Ship::GetImage(Direction direction, EngineImageType image_type, VehicleSpri
 	result->Set(_ship_sprites[spritenum] + direction);
 }
 
+/**
+ * Get the ship depots of a company, in the order of the depot pool.
+ * @param owner The company.
+ * @return The depots.
+ */
+static const std::vector<const Depot *> &GetShipDepots(Owner owner)
+{
+	static std::vector<const Depot *> depots[MAX_COMPANIES];
+	static uint32 generation = 0;
+	static bool valid = false;
+
+	if (!valid || generation != Depot::generation) {
+		for (auto &list : depots) list.clear();
+		for (const Depot *depot : Depot::Iterate()) {
+			if (!IsShipDepotTile(depot->xy)) continue;
+			Owner depot_owner = GetTileOwner(depot->xy);
+			if (depot_owner < MAX_COMPANIES) depots[depot_owner].push_back(depot);
+		}
+		generation = Depot::generation;
+		valid = true;
+	}
+
+	return depots[owner];
+}
+
 static const Depot *FindClosestShipDepot(const Vehicle *v, uint max_distance)
 {
 	/* Find the closest depot */
@@ -153,14 +178,11 @@ static const Depot *FindClosestShipDepot(const Vehicle *v, uint max_distance)
 	 * further away than max_distance can safely be ignored. */
 	uint best_dist = max_distance == 0 ? UINT_MAX : max_distance + 1;
 
-	for (const Depot *depot : Depot::Iterate()) {
-		TileIndex tile = depot->xy;
-		if (IsShipDepotTile(tile) && IsTileOwner(tile, v->owner)) {
-			uint dist = DistanceManhattan(tile, v->tile);
-			if (dist < best_dist) {
-				best_dist = dist;
-				best_depot = depot;
-			}
+	for (const Depot *depot : GetShipDepots(v->owner)) {
+		uint dist = DistanceManhattan(depot->xy, v->tile);
+		if (dist < best_dist) {
+			best_dist = dist;
+			best_depot = depot;
 		}
 	}
 
@@ -450,6 +472,113 @@ static void ShipArrivesAt(const Vehicle *v, Station *st)
 }
 
 
+/**
+ * Get the available water tracks on a tile for a ship entering a tile.
+ * @param tile The tile about to enter.
+ * @param dir The entry direction.
+ * @return The available trackbits on the next tile.
+ */
+static inline TrackBits GetAvailShipTracks(TileIndex tile, DiagDirection dir)
+{
+	TrackBits tracks = GetTileShipTrackStatus(tile) & DiagdirReachesTracks(dir);
+
+	return tracks;
+}
+
+/**
+ * Check whether a ship might have to use the pathfinder during its next tick,
+ * so it is worth to plan its track ahead; see #PlanShipTrack.
+ * @param v The ship.
+ * @return True if the track of the ship should be planned.
+ */
+bool CanPlanShipTrack(const Ship *v)
+{
+	if (_settings_game.pf.pathfinder_for_ships != VPF_YAPF) return false;
+	if ((v->vehstatus & (VS_STOPPED | VS_CRASHED | VS_HIDDEN)) != 0 || v->breakdown_ctr != 0) return false;
+	if (v->dest_tile == 0 || !v->path.empty() || v->current_order.IsType(OT_LOADING)) return false;
+	return v->state != TRACK_BIT_WORMHOLE && !v->IsInDepot() && v->direction == v->rotation;
+}
+
+/**
+ * Ask the pathfinder which track a ship should take on the tile it is about
+ * to enter, assuming it keeps moving as it does now. This is called on a
+ * worker thread before the vehicle ticks, while nothing changes the game
+ * state; so it may only read the game state and write the plan of this ship.
+ * @param v The ship.
+ * @param round The round of vehicle ticks to plan for.
+ */
+void PlanShipTrack(Ship *v, uint32 round)
+{
+	ShipTrackPlan &plan = v->plan;
+
+	/* Only plan when the ship can reach the next tile during its next tick. */
+	uint speed = std::min<uint>(v->cur_speed + 1, v->vcache.cached_max_speed);
+	speed = std::min<uint>(speed, v->current_order.GetMaxSpeed() * 2);
+	uint steps = (v->GetAdvanceSpeed(speed) + v->progress) / v->GetAdvanceDistance();
+
+	DiagDirection exitdir = VehicleExitDir(v->direction, v->state);
+	uint to_edge;
+	switch (exitdir) {
+		case DIAGDIR_NE: to_edge = (v->x_pos & 0xF) + 1; break;
+		case DIAGDIR_SE: to_edge = TILE_SIZE - (v->y_pos & 0xF); break;
+		case DIAGDIR_SW: to_edge = TILE_SIZE - (v->x_pos & 0xF); break;
+		case DIAGDIR_NW: to_edge = (v->y_pos & 0xF) + 1; break;
+		default: return;
+	}
+	if (steps < to_edge) return;
+
+	TileIndexDiffC diff = TileIndexDiffCByDiagDir(exitdir);
+	TileIndex tile = TileAddWrap(v->tile, diff.x, diff.y);
+	if (tile == INVALID_TILE || tile == v->dest_tile) return;
+
+	TrackBits tracks = GetAvailShipTracks(tile, exitdir);
+	if (tracks == TRACK_BIT_NONE) return;
+
+	plan.tile = tile;
+	plan.enterdir = exitdir;
+	plan.tracks = tracks;
+	plan.origin = v->tile;
+	plan.trackdir = v->GetVehicleTrackdir();
+	plan.dest_tile = v->dest_tile;
+	plan.order_type = v->current_order.GetType();
+	plan.order_dest = v->current_order.GetDestination();
+	plan.path.clear();
+	plan.docking.clear();
+	plan.track = YapfShipChooseTrack(v, tile, exitdir, tracks, plan.path_found, plan.path, &plan.docking);
+	plan.round = round;
+}
+
+/**
+ * Try to use the planned track of a ship, instead of running the pathfinder.
+ * The plan is only used when the pathfinder would now come to the same
+ * result, i.e. when everything it depended on did not change since planning.
+ * @param v The ship.
+ * @param tile The tile the ship is entering.
+ * @param enterdir The direction the ship is entering the tile from.
+ * @param tracks The available tracks on the tile.
+ * @param[out] track The planned track.
+ * @param[out] path_found Whether the pathfinder found a path.
+ * @return True if the plan could be used.
+ */
+static bool UsePlannedShipTrack(Ship *v, TileIndex tile, DiagDirection enterdir, TrackBits tracks, Track &track, bool &path_found)
+{
+	ShipTrackPlan &plan = v->plan;
+	if (plan.round != _vehicle_plan_round) return false;
+
+	/* A plan is only good for one try. */
+	plan.round = 0;
+
+	if (plan.tile != tile || plan.enterdir != enterdir || plan.tracks != tracks) return false;
+	if (plan.origin != v->tile || plan.trackdir != v->GetVehicleTrackdir() || plan.dest_tile != v->dest_tile) return false;
+	if (plan.order_type != v->current_order.GetType() || plan.order_dest != v->current_order.GetDestination()) return false;
+	if (!YapfShipDockingOccupancyUnchanged(plan.docking)) return false;
+
+	track = plan.track;
+	path_found = plan.path_found;
+	v->path.swap(plan.path);
+	return true;
+}
+
 /**
  * Runs the pathfinder to choose a track to continue along.
  *
@@ -487,10 +616,12 @@ static Track ChooseShipTrack(Ship *v, TileIndex tile, DiagDirection enterdir, Tr
 			v->path.clear();
 		}
 
-		switch (_settings_game.pf.pathfinder_for_ships) {
-			case VPF_NPF: track = NPFShipChooseTrack(v, path_found); break;
-			case VPF_YAPF: track = YapfShipChooseTrack(v, tile, enterdir, tracks, path_found, v->path); break;
-			default: NOT_REACHED();
+		if (!UsePlannedShipTrack(v, tile, enterdir, tracks, track, path_found)) {
+			switch (_settings_game.pf.pathfinder_for_ships) {
+				case VPF_NPF: track = NPFShipChooseTrack(v, path_found); break;
+				case VPF_YAPF: track = YapfShipChooseTrack(v, tile, enterdir, tracks, path_found, v->path); break;
+				default: NOT_REACHED();
+			}
 		}
 	}
 
@@ -498,19 +629,6 @@ static Track ChooseShipTrack(Ship *v, TileIndex tile, DiagDirection enterdir, Tr
 	return track;
 }
 
-/**
- * Get the available water tracks on a tile for a ship entering a tile.
- * @param tile The tile about to enter.
- * @param dir The entry direction.
- * @return The available trackbits on the next tile.
- */
-static inline TrackBits GetAvailShipTracks(TileIndex tile, DiagDirection dir)
-{
-	TrackBits tracks = GetTileShipTrackStatus(tile) & DiagdirReachesTracks(dir);
-
-	return tracks;
-}
-
 /** Structure for ship sub-coordinate data for moving into a new tile via a Diagdir onto a Track. */
 struct ShipSubcoordData {
 	byte x_subcoord; ///< New X sub-coordinate on the new tile
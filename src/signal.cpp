@@ -16,12 +16,13 @@
 #include "train.h"
 #include "company_base.h"
 
+#include <unordered_map>
+#include <unordered_set>
+
 #include "safeguards.h"
 
 
 /** these are the maximums used for updating signal blocks */
-static const uint SIG_TBU_SIZE    =  64; ///< number of signals entering to block
-static const uint SIG_TBD_SIZE    = 256; ///< number of intersections - open nodes in current block
 static const uint SIG_GLOB_SIZE   = 128; ///< number of open blocks (block can be opened more times until detected)
 static const uint SIG_GLOB_UPDATE =  64; ///< how many items need to be in _globset to force update
 
@@ -110,36 +111,19 @@ public:
 
 
 	/**
-	 * Tries to remove first instance of given tile and dir
-	 * @param tile tile
-	 * @param dir and dir to remove
-	 * @return element was found and removed
+	 * Removes all items for which the predicate holds
+	 * @param pred predicate taking the tile and dir of an item
 	 */
-	bool Remove(TileIndex tile, Tdir dir)
+	template <typename Tpred>
+	void RemoveIf(Tpred pred)
 	{
-		for (uint i = 0; i < this->n; i++) {
-			if (this->data[i].tile == tile && this->data[i].dir == dir) {
+		for (uint i = 0; i < this->n;) {
+			if (pred(this->data[i].tile, this->data[i].dir)) {
 				this->data[i] = this->data[--this->n];
-				return true;
+			} else {
+				i++;
 			}
 		}
-
-		return false;
-	}
-
-	/**
-	 * Tries to find given tile and dir in the set
-	 * @param tile tile
-	 * @param dir and dir to find
-	 * @return true iff the tile & dir element was found
-	 */
-	bool IsIn(TileIndex tile, Tdir dir)
-	{
-		for (uint i = 0; i < this->n; i++) {
-			if (this->data[i].tile == tile && this->data[i].dir == dir) return true;
-		}
-
-		return false;
 	}
 
 	/**
@@ -182,8 +166,6 @@ public:
 	}
 };
 
-static SmallSet<Trackdir, SIG_TBU_SIZE> _tbuset("_tbuset");         ///< set of signals that will be updated
-static SmallSet<DiagDirection, SIG_TBD_SIZE> _tbdset("_tbdset");    ///< set of open nodes in current signal block
 static SmallSet<DiagDirection, SIG_GLOB_SIZE> _globset("_globset"); ///< set of places to be updated in following runs
 
 
@@ -196,48 +178,114 @@ static Vehicle *TrainOnTileEnum(Vehicle *v, void *)
 }
 
 
+/** Place where a signal block is checked for trains. */
+struct SignalBlockProbe {
+	TileIndex tile;   ///< tile to check
+	TrackBits tracks; ///< tracks to check, INVALID_TRACK_BIT for any train on the tile that is not in a depot
+};
+
+/** Signal at the border of a signal block. */
+struct SignalBlockSignal {
+	TileIndex tile;
+	Trackdir trackdir;
+
+	bool operator<(const SignalBlockSignal &other) const
+	{
+		return this->tile != other.tile ? this->tile < other.tile : this->trackdir < other.trackdir;
+	}
+};
+
 /**
- * Perform some operations before adding data into Todo set
- * The new and reverse direction is removed from _globset, because we are sure
- * it doesn't need to be checked again
- * Also, remove reverse direction from _tbdset
- * This is the 'core' part so the graph searching won't enter any tile twice
- *
- * @param t1 tile we are entering
- * @param d1 direction (tile side) we are entering
- * @param t2 tile we are leaving
- * @param d2 direction (tile side) we are leaving
- * @return false iff reverse direction was in Todo set
+ * Signal block: all track of one owner that can be reached from a place
+ * without passing a signal. Only the layout of the block is stored, so
+ * it stays valid until track, signals or owners of its tiles change; the
+ * trains in the block and the states of its exit signals are checked
+ * every time the block is updated.
  */
-static inline bool CheckAddToTodoSet(TileIndex t1, DiagDirection d1, TileIndex t2, DiagDirection d2)
-{
-	_globset.Remove(t1, d1); // it can be in Global but not in Todo
-	_globset.Remove(t2, d2); // remove in all cases
+struct SignalBlock {
+	Owner owner;                              ///< owner of the block, INVALID_OWNER for an unused block
+	bool pbs;                                 ///< the block has a PBS signal or a two-way signal
+	std::vector<SignalBlockProbe> probes;     ///< places to check for trains
+	std::vector<SignalBlockSignal> signals;   ///< conventional signals facing into the block, sorted
+	std::vector<SignalBlockSignal> exits;     ///< presignal exits facing out of the block
+	std::vector<uint32> keys;                 ///< sides of tiles belonging to the block, see #SignalBlockKey
+};
 
-	assert(!_tbdset.IsIn(t1, d1)); // it really shouldn't be there already
+static std::vector<SignalBlock> _signal_blocks;                       ///< all signal blocks, used or not
+static std::vector<uint32> _free_signal_blocks;                       ///< indices of unused blocks in #_signal_blocks
+static std::unordered_multimap<uint32, uint32> _signal_block_keys;    ///< blocks the sides of tiles belong to
 
-	return !_tbdset.Remove(t2, d2);
+/**
+ * Key of a side of a tile in the signal block graph.
+ * @param tile tile
+ * @param dir side of the tile, INVALID_DIAGDIR for the inside of a depot or the wormhole of a tunnel or bridge
+ * @return key for #_signal_block_keys
+ */
+static inline uint32 SignalBlockKey(TileIndex tile, DiagDirection dir)
+{
+	return static_cast<uint32>(tile) << 3 | (dir == INVALID_DIAGDIR ? DIAGDIR_END : dir);
 }
 
+/**
+ * Find the signal block a side of a tile belongs to.
+ * @param tile tile
+ * @param dir side of the tile
+ * @param owner owner of the block
+ * @return index of the block in #_signal_blocks, or UINT32_MAX when it is not known yet
+ */
+static uint32 FindSignalBlock(TileIndex tile, DiagDirection dir, Owner owner)
+{
+	auto range = _signal_block_keys.equal_range(SignalBlockKey(tile, dir));
+	for (auto it = range.first; it != range.second; ++it) {
+		if (_signal_blocks[it->second].owner == owner) return it->second;
+	}
+	return UINT32_MAX;
+}
 
 /**
- * Perform some operations before adding data into Todo set
- * The new and reverse direction is removed from Global set, because we are sure
- * it doesn't need to be checked again
- * Also, remove reverse direction from Todo set
- * This is the 'core' part so the graph searching won't enter any tile twice
- *
- * @param t1 tile we are entering
- * @param d1 direction (tile side) we are entering
- * @param t2 tile we are leaving
- * @param d2 direction (tile side) we are leaving
- * @return false iff the Todo buffer would be overrun
+ * Forget a signal block.
+ * @param index index of the block in #_signal_blocks
  */
-static inline bool MaybeAddToTodoSet(TileIndex t1, DiagDirection d1, TileIndex t2, DiagDirection d2)
+static void FreeSignalBlock(uint32 index)
 {
-	if (!CheckAddToTodoSet(t1, d1, t2, d2)) return true;
+	SignalBlock &block = _signal_blocks[index];
+	for (uint32 key : block.keys) {
+		auto range = _signal_block_keys.equal_range(key);
+		for (auto it = range.first; it != range.second; ++it) {
+			if (it->second == index) {
+				_signal_block_keys.erase(it);
+				break;
+			}
+		}
+	}
+	block = SignalBlock();
+	block.owner = INVALID_OWNER;
+	_free_signal_blocks.push_back(index);
+}
+
+/**
+ * Forget the signal blocks a tile belongs to, as its track, signals or owner changed.
+ * @param tile tile that changed
+ */
+void InvalidateSignalBlocks(TileIndex tile)
+{
+	if (_signal_block_keys.empty()) return;
+
+	for (uint dir = 0; dir <= DIAGDIR_END; dir++) {
+		auto it = _signal_block_keys.find(static_cast<uint32>(tile) << 3 | dir);
+		while (it != _signal_block_keys.end()) {
+			FreeSignalBlock(it->second);
+			it = _signal_block_keys.find(static_cast<uint32>(tile) << 3 | dir);
+		}
+	}
+}
 
-	return _tbdset.Add(t1, d1);
+/** Forget all signal blocks, e.g. when a new map is loaded. */
+void InvalidateAllSignalBlocks()
+{
+	_signal_blocks.clear();
+	_free_signal_blocks.clear();
+	_signal_block_keys.clear();
 }
 
 
@@ -249,27 +297,56 @@ enum SigFlags {
 	SF_EXIT2  = 1 << 2, ///< two or more exits found
 	SF_GREEN  = 1 << 3, ///< green exitsignal found
 	SF_GREEN2 = 1 << 4, ///< two or more green exits found
-	SF_FULL   = 1 << 5, ///< some of buffers was full, do not continue
-	SF_PBS    = 1 << 6, ///< pbs signal found
+	SF_PBS    = 1 << 5, ///< pbs signal found
 };
 
 DECLARE_ENUM_AS_BIT_SET(SigFlags)
 
 
 /**
- * Search signal block
+ * Search signal block and store its layout.
+ * The block is searched from both sides of the given tile side, so the
+ * same block is found whatever side of it the search starts from.
  *
+ * @param start_tile tile we start at
+ * @param start_dir side of the tile we enter the tile from, INVALID_DIAGDIR from the inside of a depot or wormhole
  * @param owner owner whose signals we are updating
- * @return SigFlags
+ * @return index of the block in #_signal_blocks
  */
-static SigFlags ExploreSegment(Owner owner)
+static uint32 ExploreSegment(TileIndex start_tile, DiagDirection start_dir, Owner owner)
 {
-	SigFlags flags = SF_NONE;
+	SignalBlock block;
+	block.owner = owner;
+	block.pbs = false;
+
+	std::vector<std::pair<TileIndex, DiagDirection>> todo; // tiles to enter, and the side to enter them from
+	std::unordered_set<uint32> crossed; // keys of the tile sides passed already
+
+	/* Pass a tile side, entering the tile 't1' from side 'd1' after leaving tile 't2' at side 'd2'. */
+	auto cross = [&](TileIndex t1, DiagDirection d1, TileIndex t2, DiagDirection d2) {
+		if (!crossed.insert(SignalBlockKey(t1, d1)).second) return;
+		crossed.insert(SignalBlockKey(t2, d2));
+		todo.emplace_back(t1, d1);
+	};
 
-	TileIndex tile = INVALID_TILE; // Stop GCC from complaining about a possibly uninitialized variable (issue #8280).
-	DiagDirection enterdir = INVALID_DIAGDIR;
+	/* Start at both sides of the given tile side, like everyone entering the block through it would. */
+	crossed.insert(SignalBlockKey(start_tile, start_dir));
+	todo.emplace_back(start_tile, start_dir);
+	if (start_dir != INVALID_DIAGDIR) {
+		TileIndex other = start_tile + TileOffsByDiagDir(start_dir);
+		crossed.insert(SignalBlockKey(other, ReverseDiagDir(start_dir)));
+		todo.emplace_back(other, ReverseDiagDir(start_dir));
+	} else if (IsTileType(start_tile, MP_TUNNELBRIDGE)) {
+		TileIndex other = GetOtherTunnelBridgeEnd(start_tile);
+		crossed.insert(SignalBlockKey(other, INVALID_DIAGDIR));
+		todo.emplace_back(other, INVALID_DIAGDIR);
+	}
+
+	while (!todo.empty()) {
+		TileIndex tile = todo.back().first;
+		DiagDirection enterdir = todo.back().second;
+		todo.pop_back();
 
-	while (_tbdset.Get(&tile, &enterdir)) { // tile and enterdir are initialized here, unless I'm mistaken.
 		TileIndex oldtile = tile; // tile we are leaving
 		DiagDirection exitdir = enterdir == INVALID_DIAGDIR ? INVALID_DIAGDIR : ReverseDiagDir(enterdir); // expected new exit direction (for straight line)
 
@@ -279,13 +356,15 @@ static SigFlags ExploreSegment(Owner owner)
 
 				if (IsRailDepot(tile)) {
 					if (enterdir == INVALID_DIAGDIR) { // from 'inside' - train just entered or left the depot
-						if (!(flags & SF_TRAIN) && HasVehicleOnPos(tile, nullptr, &TrainOnTileEnum)) flags |= SF_TRAIN;
+						block.probes.push_back({tile, INVALID_TRACK_BIT});
 						exitdir = GetRailDepotDirection(tile);
 						tile += TileOffsByDiagDir(exitdir);
 						enterdir = ReverseDiagDir(exitdir);
 						break;
 					} else if (enterdir == GetRailDepotDirection(tile)) { // entered a depot
-						if (!(flags & SF_TRAIN) && HasVehicleOnPos(tile, nullptr, &TrainOnTileEnum)) flags |= SF_TRAIN;
+						block.probes.push_back({tile, INVALID_TRACK_BIT});
+						/* The inside belongs to the block too, as the depot is left through this side. */
+						crossed.insert(SignalBlockKey(tile, INVALID_DIAGDIR));
 						continue;
 					} else {
 						continue;
@@ -298,11 +377,10 @@ static SigFlags ExploreSegment(Owner owner)
 
 				if (tracks == TRACK_BIT_HORZ || tracks == TRACK_BIT_VERT) { // there is exactly one incidating track, no need to check
 					tracks = tracks_masked;
-					/* If no train detected yet, and there is not no train -> there is a train -> set the flag */
-					if (!(flags & SF_TRAIN) && EnsureNoTrainOnTrackBits(tile, tracks).Failed()) flags |= SF_TRAIN;
+					block.probes.push_back({tile, tracks});
 				} else {
 					if (tracks_masked == TRACK_BIT_NONE) continue; // no incidating track
-					if (!(flags & SF_TRAIN) && HasVehicleOnPos(tile, nullptr, &TrainOnTileEnum)) flags |= SF_TRAIN;
+					block.probes.push_back({tile, INVALID_TRACK_BIT});
 				}
 
 				if (HasSignals(tile)) { // there is exactly one track - not zero, because there is exit from this tile
@@ -316,22 +394,15 @@ static SigFlags ExploreSegment(Owner owner)
 						 * (if it is a presignal EXIT and it changes, it will be added to 'to-be-done' set later) */
 						if (HasSignalOnTrackdir(tile, reversedir)) {
 							if (IsPbsSignal(sig)) {
-								flags |= SF_PBS;
-							} else if (!_tbuset.Add(tile, reversedir)) {
-								return flags | SF_FULL;
-							}
-						}
-						if (HasSignalOnTrackdir(tile, trackdir) && !IsOnewaySignal(tile, track)) flags |= SF_PBS;
-
-						/* if it is a presignal EXIT in OUR direction and we haven't found 2 green exits yes, do special check */
-						if (!(flags & SF_GREEN2) && IsPresignalExit(tile, track) && HasSignalOnTrackdir(tile, trackdir)) { // found presignal exit
-							if (flags & SF_EXIT) flags |= SF_EXIT2; // found two (or more) exits
-							flags |= SF_EXIT; // found at least one exit - allow for compiler optimizations
-							if (GetSignalStateByTrackdir(tile, trackdir) == SIGNAL_STATE_GREEN) { // found green presignal exit
-								if (flags & SF_GREEN) flags |= SF_GREEN2;
-								flags |= SF_GREEN;
+								block.pbs = true;
+							} else {
+								block.signals.push_back({tile, reversedir});
 							}
 						}
+						if (HasSignalOnTrackdir(tile, trackdir) && !IsOnewaySignal(tile, track)) block.pbs = true;
+
+						/* if it is a presignal EXIT in OUR direction, its state counts for the block */
+						if (IsPresignalExit(tile, track) && HasSignalOnTrackdir(tile, trackdir)) block.exits.push_back({tile, trackdir});
 
 						continue;
 					}
@@ -341,7 +412,7 @@ static SigFlags ExploreSegment(Owner owner)
 					if (dir != enterdir && (tracks & _enterdir_to_trackbits[dir])) { // any track incidating?
 						TileIndex newtile = tile + TileOffsByDiagDir(dir);  // new tile to check
 						DiagDirection newdir = ReverseDiagDir(dir); // direction we are entering from
-						if (!MaybeAddToTodoSet(newtile, newdir, tile, dir)) return flags | SF_FULL;
+						cross(newtile, newdir, tile, dir);
 					}
 				}
 
@@ -354,7 +425,7 @@ static SigFlags ExploreSegment(Owner owner)
 				if (DiagDirToAxis(enterdir) != GetRailStationAxis(tile)) continue; // different axis
 				if (IsStationTileBlocked(tile)) continue; // 'eye-candy' station tile
 
-				if (!(flags & SF_TRAIN) && HasVehicleOnPos(tile, nullptr, &TrainOnTileEnum)) flags |= SF_TRAIN;
+				block.probes.push_back({tile, INVALID_TRACK_BIT});
 				tile += TileOffsByDiagDir(exitdir);
 				break;
 
@@ -363,7 +434,7 @@ static SigFlags ExploreSegment(Owner owner)
 				if (GetTileOwner(tile) != owner) continue;
 				if (DiagDirToAxis(enterdir) == GetCrossingRoadAxis(tile)) continue; // different axis
 
-				if (!(flags & SF_TRAIN) && HasVehicleOnPos(tile, nullptr, &TrainOnTileEnum)) flags |= SF_TRAIN;
+				block.probes.push_back({tile, INVALID_TRACK_BIT});
 				tile += TileOffsByDiagDir(exitdir);
 				break;
 
@@ -373,13 +444,13 @@ static SigFlags ExploreSegment(Owner owner)
 				DiagDirection dir = GetTunnelBridgeDirection(tile);
 
 				if (enterdir == INVALID_DIAGDIR) { // incoming from the wormhole
-					if (!(flags & SF_TRAIN) && HasVehicleOnPos(tile, nullptr, &TrainOnTileEnum)) flags |= SF_TRAIN;
+					block.probes.push_back({tile, INVALID_TRACK_BIT});
 					enterdir = dir;
 					exitdir = ReverseDiagDir(dir);
 					tile += TileOffsByDiagDir(exitdir); // just skip to next tile
 				} else { // NOT incoming from the wormhole!
 					if (ReverseDiagDir(enterdir) != dir) continue;
-					if (!(flags & SF_TRAIN) && HasVehicleOnPos(tile, nullptr, &TrainOnTileEnum)) flags |= SF_TRAIN;
+					block.probes.push_back({tile, INVALID_TRACK_BIT});
 					tile = GetOtherTunnelBridgeEnd(tile); // just skip to exit tile
 					enterdir = INVALID_DIAGDIR;
 					exitdir = INVALID_DIAGDIR;
@@ -391,7 +462,67 @@ static SigFlags ExploreSegment(Owner owner)
 				continue; // continue the while() loop
 		}
 
-		if (!MaybeAddToTodoSet(tile, enterdir, oldtile, exitdir)) return flags | SF_FULL;
+		cross(tile, enterdir, oldtile, exitdir);
+	}
+
+	/* The order the signals are updated in must not depend on where the search started. */
+	std::sort(block.signals.begin(), block.signals.end());
+
+	uint32 index;
+	if (_free_signal_blocks.empty()) {
+		index = static_cast<uint32>(_signal_blocks.size());
+		_signal_blocks.emplace_back();
+	} else {
+		index = _free_signal_blocks.back();
+		_free_signal_blocks.pop_back();
+	}
+
+	block.keys.assign(crossed.begin(), crossed.end());
+	for (uint32 key : block.keys) {
+		/* A block with the same tile side must be the same block, found before the layout changed. */
+		auto range = _signal_block_keys.equal_range(key);
+		for (auto it = range.first; it != range.second; ++it) {
+			if (_signal_blocks[it->second].owner == owner) {
+				FreeSignalBlock(it->second);
+				break;
+			}
+		}
+		_signal_block_keys.emplace(key, index);
+	}
+	_signal_blocks[index] = std::move(block);
+
+	return index;
+}
+
+
+/**
+ * Check the trains and exit signals of a signal block.
+ *
+ * @param block the signal block
+ * @return SigFlags
+ */
+static SigFlags GetSignalBlockFlags(const SignalBlock &block)
+{
+	SigFlags flags = block.pbs ? SF_PBS : SF_NONE;
+
+	for (const SignalBlockProbe &probe : block.probes) {
+		bool train = (probe.tracks == INVALID_TRACK_BIT) ?
+				HasVehicleOnPos(probe.tile, nullptr, &TrainOnTileEnum) :
+				EnsureNoTrainOnTrackBits(probe.tile, probe.tracks).Failed();
+		if (train) {
+			flags |= SF_TRAIN;
+			break;
+		}
+	}
+
+	for (const SignalBlockSignal &exit : block.exits) {
+		if (flags & SF_GREEN2) break;
+		if (flags & SF_EXIT) flags |= SF_EXIT2; // found two (or more) exits
+		flags |= SF_EXIT; // found at least one exit - allow for compiler optimizations
+		if (GetSignalStateByTrackdir(exit.tile, exit.trackdir) == SIGNAL_STATE_GREEN) { // found green presignal exit
+			if (flags & SF_GREEN) flags |= SF_GREEN2;
+			flags |= SF_GREEN;
+		}
 	}
 
 	return flags;
@@ -399,16 +530,16 @@ static SigFlags ExploreSegment(Owner owner)
 
 
 /**
- * Update signals around segment in _tbuset
+ * Update signals around segment
  *
+ * @param block the signal block
  * @param flags info about segment
  */
-static void UpdateSignalsAroundSegment(SigFlags flags)
+static void UpdateSignalsAroundSegment(const SignalBlock &block, SigFlags flags)
 {
-	TileIndex tile = INVALID_TILE; // Stop GCC from complaining about a possibly uninitialized variable (issue #8280).
-	Trackdir trackdir = INVALID_TRACKDIR;
-
-	while (_tbuset.Get(&tile, &trackdir)) {
+	for (const SignalBlockSignal &signal : block.signals) {
+		TileIndex tile = signal.tile;
+		Trackdir trackdir = signal.trackdir;
 		assert(HasSignalOnTrackdir(tile, trackdir));
 
 		SignalType sig = GetSignalType(tile, TrackdirToTrack(trackdir));
@@ -449,15 +580,6 @@ static void UpdateSignalsAroundSegment(SigFlags flags)
 }
 
 
-/** Reset all sets after one set overflowed */
-static inline void ResetSets()
-{
-	_tbuset.Reset();
-	_tbdset.Reset();
-	_globset.Reset();
-}
-
-
 /**
  * Updates blocks in _globset buffer
  *
@@ -476,9 +598,6 @@ static SigSegState UpdateSignalsInBuffer(Owner owner)
 	DiagDirection dir = INVALID_DIAGDIR;
 
 	while (_globset.Get(&tile, &dir)) {
-		assert(_tbuset.IsEmpty());
-		assert(_tbdset.IsEmpty());
-
 		/* After updating signal, data stored are always MP_RAILWAY with signals.
 		 * Other situations happen when data are from outside functions -
 		 * modification of railbits (including both rail building and removal),
@@ -489,15 +608,14 @@ static SigSegState UpdateSignalsInBuffer(Owner owner)
 				/* 'optimization assert' - do not try to update signals when it is not needed */
 				assert(GetTunnelBridgeTransportType(tile) == TRANSPORT_RAIL);
 				assert(dir == INVALID_DIAGDIR || dir == ReverseDiagDir(GetTunnelBridgeDirection(tile)));
-				_tbdset.Add(tile, INVALID_DIAGDIR);  // we can safely start from wormhole centre
-				_tbdset.Add(GetOtherTunnelBridgeEnd(tile), INVALID_DIAGDIR);
+				dir = INVALID_DIAGDIR; // we can safely start from wormhole centre
 				break;
 
 			case MP_RAILWAY:
 				if (IsRailDepot(tile)) {
 					/* 'optimization assert' do not try to update signals in other cases */
 					assert(dir == INVALID_DIAGDIR || dir == GetRailDepotDirection(tile));
-					_tbdset.Add(tile, INVALID_DIAGDIR); // start from depot inside
+					dir = INVALID_DIAGDIR; // start from depot inside
 					break;
 				}
 				FALLTHROUGH;
@@ -506,8 +624,6 @@ static SigSegState UpdateSignalsInBuffer(Owner owner)
 			case MP_ROAD:
 				if ((TrackStatusToTrackBits(GetTileTrackStatus(tile, TRANSPORT_RAIL, 0)) & _enterdir_to_trackbits[dir]) != TRACK_BIT_NONE) {
 					/* only add to set when there is some 'interesting' track */
-					_tbdset.Add(tile, dir);
-					_tbdset.Add(tile + TileOffsByDiagDir(dir), ReverseDiagDir(dir));
 					break;
 				}
 				FALLTHROUGH;
@@ -517,35 +633,33 @@ static SigSegState UpdateSignalsInBuffer(Owner owner)
 				tile = tile + TileOffsByDiagDir(dir);
 				dir = ReverseDiagDir(dir);
 				if ((TrackStatusToTrackBits(GetTileTrackStatus(tile, TRANSPORT_RAIL, 0)) & _enterdir_to_trackbits[dir]) != TRACK_BIT_NONE) {
-					_tbdset.Add(tile, dir);
 					break;
 				}
 				/* happens when removing a rail that wasn't connected at one or both sides */
 				continue; // continue the while() loop
 		}
 
-		assert(!_tbdset.Overflowed()); // it really shouldn't overflow by these one or two items
-		assert(!_tbdset.IsEmpty()); // it wouldn't hurt anyone, but shouldn't happen too
+		/* Only search the block when its layout is not known. */
+		uint32 index = FindSignalBlock(tile, dir, owner);
+		if (index == UINT32_MAX) index = ExploreSegment(tile, dir, owner);
+		const SignalBlock &block = _signal_blocks[index];
+
+		/* The block is updated now, so no need to do it again for other places in it. */
+		_globset.RemoveIf([&](TileIndex t, DiagDirection d) { return FindSignalBlock(t, d, owner) == index; });
 
-		SigFlags flags = ExploreSegment(owner);
+		SigFlags flags = GetSignalBlockFlags(block);
 
 		if (first) {
 			first = false;
 			/* SIGSEG_FREE is set by default */
 			if (flags & SF_PBS) {
 				state = SIGSEG_PBS;
-			} else if ((flags & SF_TRAIN) || ((flags & SF_EXIT) && !(flags & SF_GREEN)) || (flags & SF_FULL)) {
+			} else if ((flags & SF_TRAIN) || ((flags & SF_EXIT) && !(flags & SF_GREEN))) {
 				state = SIGSEG_FULL;
 			}
 		}
 
-		/* do not do anything when some buffer was full */
-		if (flags & SF_FULL) {
-			ResetSets(); // free all sets
-			break;
-		}
-
-		UpdateSignalsAroundSegment(flags);
+		UpdateSignalsAroundSegment(block, flags);
 	}
 
 	return state;
@@ -21,6 +21,7 @@
 #include "core/pool_func.hpp"
 #include "station_base.h"
 #include "station_kdtree.h"
+#include "station_func.h"
 #include "roadstop_base.h"
 #include "industry.h"
 #include "town.h"
@@ -69,7 +70,10 @@ Station::Station(TileIndex tile) :
 	indtype(IT_INVALID),
 	time_since_load(255),
 	time_since_unload(255),
-	last_vehicle_type(VEH_INVALID)
+	last_vehicle_type(VEH_INVALID),
+	rating_cargoes(ALL_CARGOTYPES),
+	catchment_acceptance_valid(false),
+	rating_phase(INVALID_RATING_PHASE)
 {
 	/* this->random_bits is set in Station::AddFacility() */
 }
@@ -90,6 +94,8 @@ Station::~Station()
 		return;
 	}
 
+	UnscheduleStationRating(this);
+
 	while (!this->loading_vehicles.empty()) {
 		this->loading_vehicles.front()->LeaveStation();
 	}
@@ -203,6 +209,7 @@ void Station::AddFacility(StationFacility new_facility_bit, TileIndex facil_xy)
 		this->random_bits = Random();
 	}
 	this->facilities |= new_facility_bit;
+	UpdateStationRatingSchedule(this);
 	this->owner = _current_company;
 	this->build_date = _date;
 }
@@ -428,6 +435,7 @@ bool Station::CatchmentCoversTown(TownID t) const
  */
 void Station::RecomputeCatchment()
 {
+	this->catchment_acceptance_valid = false;
 	this->industries_near.clear();
 	this->RemoveFromAllNearbyLists();
 
@@ -451,6 +451,8 @@ struct IndustryCompare {
 typedef std::set<IndustryListEntry, IndustryCompare> IndustryList;
 
 /** Station data structure */
+static const byte INVALID_RATING_PHASE = 0xFF; ///< Rating phase of a station that is not in the station rating schedule.
+
 struct Station FINAL : SpecializedStation<Station, false> {
 public:
 	RoadStop *GetPrimaryRoadStop(RoadStopType type) const
@@ -481,7 +483,11 @@ public:
 	byte last_vehicle_type;
 	std::list<Vehicle *> loading_vehicles;
 	GoodsEntry goods[NUM_CARGO];  ///< Goods at this station
+	CargoTypes rating_cargoes;    ///< NOSAVE: Cargo types whose rating may change in UpdateStationRating(); may contain more types than needed.
 	CargoTypes always_accepted;       ///< Bitmask of always accepted cargo types (by houses, HQs, industry tiles when industry doesn't accept cargo)
+	CargoArray catchment_acceptance;  ///< NOSAVE: Acceptance of the tiles in the catchment area, only valid if #catchment_acceptance_valid is set.
+	bool catchment_acceptance_valid;  ///< NOSAVE: Whether #catchment_acceptance and #always_accepted match the tiles in the catchment area, @see InvalidateStationAcceptanceAroundTiles()
+	byte rating_phase;                ///< NOSAVE: Bucket of the station rating schedule this station is in, or #INVALID_RATING_PHASE when it is not in use, @see UpdateStationRatingSchedule()
 
 	IndustryList industries_near; ///< Cached list of industries near the station that can accept cargo, @see DeliverGoodsToIndustry()
 	Industry *industry;           ///< NOSAVE: Associated industry for neutral stations. (Rebuilt on load from Industry->st)
@@ -562,24 +562,78 @@ CargoArray GetAcceptanceAroundTiles(TileIndex center_tile, int w, int h, int rad
 	return acceptance;
 }
 
+/**
+ * Check whether the acceptance of a tile is decided by NewGRF callbacks, so
+ * it may change without anything happening to the tile.
+ * @param tile Tile to check.
+ * @return True if the acceptance of the tile may change at any time.
+ */
+static bool HasVariableAcceptance(TileIndex tile)
+{
+	switch (GetTileType(tile)) {
+		case MP_HOUSE: {
+			const HouseSpec *hs = HouseSpec::Get(GetHouseType(tile));
+			return HasBit(hs->callback_mask, CBM_HOUSE_ACCEPT_CARGO) || HasBit(hs->callback_mask, CBM_HOUSE_CARGO_ACCEPTANCE);
+		}
+
+		case MP_INDUSTRY: {
+			const IndustryTileSpec *itspec = GetIndustryTileSpec(GetIndustryGfx(tile));
+			return HasBit(itspec->callback_mask, CBM_INDT_ACCEPT_CARGO) || HasBit(itspec->callback_mask, CBM_INDT_CARGO_ACCEPTANCE);
+		}
+
+		default:
+			return false;
+	}
+}
+
 /**
  * Get the acceptance of cargoes around the station in.
  * @param st Station to get acceptance of.
  * @param always_accepted bitmask of cargo accepted by houses and headquarters; can be nullptr
+ * @param[out] fixed Set to whether the acceptance only changes when a tile in the catchment area is changed.
  */
-static CargoArray GetAcceptanceAroundStation(const Station *st, CargoTypes *always_accepted)
+static CargoArray GetAcceptanceAroundStation(const Station *st, CargoTypes *always_accepted, bool *fixed)
 {
 	CargoArray acceptance;
 	if (always_accepted != nullptr) *always_accepted = 0;
+	*fixed = true;
 
 	BitmapTileIterator it(st->catchment_tiles);
 	for (TileIndex tile = it; tile != INVALID_TILE; tile = ++it) {
 		AddAcceptedCargo(tile, acceptance, always_accepted);
+		if (*fixed && HasVariableAcceptance(tile)) *fixed = false;
 	}
 
 	return acceptance;
 }
 
+/**
+ * Tell the stations that have any of the given tiles in their catchment area
+ * that the acceptance of these tiles changed, so they have to look at their
+ * catchment area again the next time their acceptance is updated.
+ * @param ta Tiles whose acceptance changed.
+ */
+void InvalidateStationAcceptanceAroundTiles(const TileArea &ta)
+{
+	if (Station::GetNumItems() == 0) return;
+
+	/* Unlike ForAllStationsAroundTiles(), also include neutral stations; they accept cargo for their industry tiles. */
+	uint max_c = _settings_game.station.modified_catchment ? MAX_CATCHMENT : CA_UNMODIFIED;
+	for (TileIndex tile : TileArea(ta).Expand(max_c)) {
+		if (!IsTileType(tile, MP_STATION)) continue;
+
+		Station *st = Station::GetIfValid(GetStationIndex(tile));
+		if (st == nullptr || !st->catchment_acceptance_valid) continue;
+
+		for (TileIndex tile2 : ta) {
+			if (st->TileIsInCatchment(tile2)) {
+				st->catchment_acceptance_valid = false;
+				break;
+			}
+		}
+	}
+}
+
 /**
  * Update the acceptance for a station.
  * @param st Station to update
@@ -593,7 +647,11 @@ void UpdateStationAcceptance(Station *st, bool show_msg)
 	/* And retrieve the acceptance. */
 	CargoArray acceptance;
 	if (!st->rect.IsEmpty()) {
-		acceptance = GetAcceptanceAroundStation(st, &st->always_accepted);
+		/* Only look at the catchment area again when it or one of its tiles changed. */
+		if (!st->catchment_acceptance_valid) {
+			st->catchment_acceptance = GetAcceptanceAroundStation(st, &st->always_accepted, &st->catchment_acceptance_valid);
+		}
+		acceptance = st->catchment_acceptance;
 	}
 
 	/* Adjust in case our station only accepts fewer kinds of goods */
@@ -1634,6 +1692,7 @@ CommandCost RemoveFromRailBaseStation(TileArea ta, std::vector<T *> &affected_st
 		/* if we deleted the whole station, delete the train facility. */
 		if (st->train_station.tile == INVALID_TILE) {
 			st->facilities &= ~FACIL_TRAIN;
+			if (Station::IsExpected(st)) UpdateStationRatingSchedule(Station::From(st));
 			SetWindowWidgetDirty(WC_STATION_VIEW, st->index, WID_SV_TRAINS);
 			MarkCatchmentTilesDirty();
 			st->UpdateVirtCoord();
@@ -1922,6 +1981,7 @@ CommandCost CmdBuildRoadStop(DoCommandFlag flags, TileIndex tile, uint8 width, u
 			Company::Get(st->owner)->infrastructure.station++;
 
 			MarkTileDirtyByTile(cur_tile);
+			YapfNotifyRoadLayoutChange(cur_tile);
 		}
 
 		if (st != nullptr) {
@@ -1994,6 +2054,7 @@ static CommandCost RemoveRoadStop(TileIndex tile, DoCommandFlag flags)
 			/* removed the only stop? */
 			if (*primary_stop == nullptr) {
 				st->facilities &= (is_truck ? ~FACIL_TRUCK_STOP : ~FACIL_BUS_STOP);
+				UpdateStationRatingSchedule(st);
 			}
 		} else {
 			/* tell the predecessor in the list to skip this stop */
@@ -2019,6 +2080,7 @@ static CommandCost RemoveRoadStop(TileIndex tile, DoCommandFlag flags)
 		}
 
 		delete cur_stop;
+		YapfNotifyRoadLayoutChange(tile);
 
 		/* Make sure no vehicle is going to the old roadstop */
 		for (RoadVehicle *v : RoadVehicle::Iterate()) {
@@ -2400,6 +2462,7 @@ static CommandCost RemoveAirport(TileIndex tile, DoCommandFlag flags)
 
 		st->airport.Clear();
 		st->facilities &= ~FACIL_AIRPORT;
+		UpdateStationRatingSchedule(st);
 
 		InvalidateWindowData(WC_STATION_VIEW, st->index, -1);
 
@@ -2667,6 +2730,7 @@ static CommandCost RemoveDock(TileIndex tile, DoCommandFlag flags)
 			st->ship_station.Clear();
 			st->docking_station.Clear();
 			st->facilities &= ~FACIL_DOCK;
+			UpdateStationRatingSchedule(st);
 		}
 
 		Company::Get(st->owner)->infrastructure.station -= 2;
@@ -3426,8 +3490,11 @@ static void UpdateStationRating(Station *st)
 	byte_inc_sat(&st->time_since_load);
 	byte_inc_sat(&st->time_since_unload);
 
-	for (const CargoSpec *cs : CargoSpec::Iterate()) {
-		GoodsEntry *ge = &st->goods[cs->Index()];
+	for (CargoID c : SetBitIterator<CargoID>(st->rating_cargoes)) {
+		const CargoSpec *cs = CargoSpec::Get(c);
+		if (!cs->IsValid()) continue;
+
+		GoodsEntry *ge = &st->goods[c];
 		/* Slowly increase the rating back to its original level in the case we
 		 *  didn't deliver cargo yet to this station. This happens when a bribe
 		 *  failed while you didn't moved that cargo yet to a station. */
@@ -3435,6 +3502,9 @@ static void UpdateStationRating(Station *st)
 			ge->rating++;
 		}
 
+		/* Skip this cargo until it gets a rating or its rating is lowered. */
+		if (!ge->HasRating() && ge->rating >= INITIAL_STATION_RATING) ClrBit(st->rating_cargoes, c);
+
 		/* Only change the rating if we are moving this cargo */
 		if (ge->HasRating()) {
 			byte_inc_sat(&ge->time_since_pickup);
@@ -3769,36 +3839,131 @@ void IncreaseStats(Station *st, const Vehicle *front, StationID next_station_id,
 	}
 }
 
-/* called for every station each tick */
-static void StationHandleSmallTick(BaseStation *st)
+/**
+ * Get the lowest station index that has its turn for a periodic task in the current tick.
+ * Station index is included in the period so that the tasks of all stations are not done
+ * at the same time; the stations with their turn are this index plus multiples of the period.
+ * @param period Number of ticks between two runs of the task for a station.
+ * @return The station index.
+ */
+static inline uint GetFirstStationIndexForTick(uint period)
 {
-	if ((st->facilities & FACIL_WAYPOINT) != 0 || !st->IsInUse()) return;
+	return (period - _tick_counter % period) % period;
+}
 
+/** Number of times OnTick_Station() has run, modulo #STATION_RATING_TICKS. */
+static uint _station_rating_tick;
+/** The stations in use, bucketed by the value of #_station_rating_tick at which their rating is updated. */
+static std::set<StationID> _station_rating_schedule[STATION_RATING_TICKS];
+
+/**
+ * Add a station to or remove it from the rating schedule, depending on whether it is in use.
+ * While a station is scheduled, its rating countdown follows from its bucket and
+ * BaseStation::delete_ctr is only brought up to date when the station leaves the schedule.
+ * @param st Station whose facilities have changed.
+ */
+void UpdateStationRatingSchedule(Station *st)
+{
+	if (!st->IsInUse()) {
+		UnscheduleStationRating(st);
+		return;
+	}
+	if (st->rating_phase != INVALID_RATING_PHASE) return;
+
+	/* The countdown value the station gets on the next tick. */
 	byte b = st->delete_ctr + 1;
 	if (b >= STATION_RATING_TICKS) b = 0;
-	st->delete_ctr = b;
 
-	if (b == 0) UpdateStationRating(Station::From(st));
+	st->rating_phase = (_station_rating_tick + 1 + STATION_RATING_TICKS - b) % STATION_RATING_TICKS;
+	_station_rating_schedule[st->rating_phase].insert(st->index);
+}
+
+/**
+ * Get the current rating countdown of a scheduled station.
+ * @param st Station in the rating schedule.
+ * @return The number of ticks since the last rating update of the station.
+ */
+static byte GetStationRatingCounter(const Station *st)
+{
+	return (_station_rating_tick + STATION_RATING_TICKS - st->rating_phase) % STATION_RATING_TICKS;
+}
+
+/**
+ * Remove a station from the rating schedule and store its rating countdown in BaseStation::delete_ctr.
+ * @param st Station to remove; nothing happens if it is not scheduled.
+ */
+void UnscheduleStationRating(Station *st)
+{
+	if (st->rating_phase == INVALID_RATING_PHASE) return;
+
+	st->delete_ctr = GetStationRatingCounter(st);
+	_station_rating_schedule[st->rating_phase].erase(st->index);
+	st->rating_phase = INVALID_RATING_PHASE;
+}
+
+/** Store the rating countdown of all scheduled stations in BaseStation::delete_ctr, so it can be saved. */
+void StoreStationRatingCounters()
+{
+	for (Station *st : Station::Iterate()) {
+		if (st->rating_phase != INVALID_RATING_PHASE) st->delete_ctr = GetStationRatingCounter(st);
+	}
+}
+
+/** Rebuild the station rating schedule from the rating countdowns in BaseStation::delete_ctr. */
+void RebuildStationRatingSchedule()
+{
+	_station_rating_tick = 0;
+	for (std::set<StationID> &bucket : _station_rating_schedule) bucket.clear();
+
+	for (Station *st : Station::Iterate()) {
+		st->rating_phase = INVALID_RATING_PHASE;
+		UpdateStationRatingSchedule(st);
+	}
+}
+
+/** Reset the station rating schedule for a new game. */
+void InitializeStations()
+{
+	RebuildStationRatingSchedule();
 }
 
 void OnTick_Station()
 {
 	if (_game_mode == GM_EDITOR) return;
 
-	for (BaseStation *st : BaseStation::Iterate()) {
-		StationHandleSmallTick(st);
+	_station_rating_tick = (_station_rating_tick + 1) % STATION_RATING_TICKS;
+
+	/* Only visit the stations with something to do in this tick. They are visited
+	 * in order of their index, just like when iterating over all stations, so the
+	 * order of the random calls does not depend on the scheduling. */
+	const std::set<StationID> &rating = _station_rating_schedule[_station_rating_tick];
+	auto next_rating = rating.begin();
+	uint next_linkgraph = GetFirstStationIndexForTick(STATION_LINKGRAPH_TICKS);
+	uint next_big_tick = GetFirstStationIndexForTick(STATION_ACCEPTANCE_TICKS);
+	const uint end = (uint)BaseStation::GetPoolSize();
+
+	for (;;) {
+		uint index = std::min(next_linkgraph, next_big_tick);
+		if (next_rating != rating.end()) index = std::min<uint>(index, *next_rating);
+		if (index >= end) break;
+
+		if (next_rating != rating.end() && *next_rating == index) {
+			++next_rating;
+			UpdateStationRating(Station::Get(index));
+		}
 
 		/* Clean up the link graph about once a week. */
-		if (Station::IsExpected(st) && (_tick_counter + st->index) % STATION_LINKGRAPH_TICKS == 0) {
-			DeleteStaleLinks(Station::From(st));
-		};
+		if (next_linkgraph == index) {
+			next_linkgraph += STATION_LINKGRAPH_TICKS;
+			if (Station::IsValidID(index)) DeleteStaleLinks(Station::Get(index));
+		}
 
-		/* Run STATION_ACCEPTANCE_TICKS = 250 tick interval trigger for station animation.
-		 * Station index is included so that triggers are not all done
-		 * at the same time. */
-		if ((_tick_counter + st->index) % STATION_ACCEPTANCE_TICKS == 0) {
+		/* Run STATION_ACCEPTANCE_TICKS = 250 tick interval trigger for station animation. */
+		if (next_big_tick == index) {
+			next_big_tick += STATION_ACCEPTANCE_TICKS;
+			BaseStation *st = BaseStation::GetIfValid(index);
 			/* Stop processing this station if it was deleted */
-			if (!StationHandleBigTick(st)) continue;
+			if (st == nullptr || !StationHandleBigTick(st)) continue;
 			TriggerStationAnimation(st, st->xy, SAT_250_TICKS);
 			if (Station::IsExpected(st)) AirportAnimationTrigger(Station::From(st), AAT_STATION_250_TICKS);
 		}
@@ -3827,6 +3992,7 @@ void ModifyStationRatingAround(TileIndex tile, Owner owner, int amount, uint rad
 
 				if (ge->status != 0) {
 					ge->rating = Clamp(ge->rating + amount, 0, 255);
+					SetBit(st->rating_cargoes, i);
 				}
 			}
 		}
@@ -3867,6 +4033,7 @@ static uint UpdateStationWaiting(Station *st, CargoID type, uint amount, SourceT
 	if (!ge.HasRating()) {
 		InvalidateWindowData(WC_STATION_LIST, st->index);
 		SetBit(ge.status, GoodsEntry::GES_RATING);
+		SetBit(st->rating_cargoes, type);
 	}
 
 	TriggerStationRandomisation(st, st->xy, SRT_NEW_CARGO, type);
@@ -4111,6 +4278,7 @@ void BuildOilRig(TileIndex tile)
 	st->airport.Add(tile);
 	st->ship_station.Add(tile);
 	st->facilities = FACIL_AIRPORT | FACIL_DOCK;
+	UpdateStationRatingSchedule(st);
 	st->build_date = _date;
 	UpdateStationDockingTiles(st);
 
@@ -19,6 +19,7 @@
 #include "road.h"
 #include "linkgraph/linkgraph_type.h"
 #include "industry_type.h"
+#include "tilearea_type.h"
 
 void ModifyStationRatingAround(TileIndex tile, Owner owner, int amount, uint radius);
 
@@ -31,6 +32,12 @@ CargoArray GetAcceptanceAroundTiles(TileIndex tile, int w, int h, int rad, Cargo
 
 void UpdateStationAcceptance(Station *st, bool show_msg);
 
+void UpdateStationRatingSchedule(Station *st);
+void UnscheduleStationRating(Station *st);
+void StoreStationRatingCounters();
+void RebuildStationRatingSchedule();
+void InvalidateStationAcceptanceAroundTiles(const TileArea &ta);
+
 const DrawTileSprites *GetStationTileLayout(StationType st, byte gfx);
 void StationPickerDrawSprite(int x, int y, StationType st, RailType railtype, RoadType roadtype, int image);
 
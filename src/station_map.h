@@ -81,6 +81,7 @@ static inline void SetStationGfx(TileIndex t, StationGfx gfx)
 {
 	assert(IsTileType(t, MP_STATION));
 	_m[t].m5 = gfx;
+	InvalidateReservationIndex();
 }
 
 /**
@@ -406,6 +407,7 @@ static inline void SetRailStationReservation(TileIndex t, bool b)
 {
 	assert(HasStationRail(t));
 	SB(_me[t].m6, 2, 1, b ? 1 : 0);
+	InvalidateReservationIndex();
 }
 
 /**
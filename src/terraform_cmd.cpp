@@ -19,6 +19,9 @@
 #include "core/backup_type.hpp"
 #include "terraform_cmd.h"
 #include "landscape_cmd.h"
+#include "rail_map.h"
+#include "road_map.h"
+#include "pathfinder/yapf/yapf_cache.h"
 
 #include "table/strings.h"
 
@@ -317,6 +320,13 @@ std::tuple<CommandCost, Money, TileIndex> CmdTerraformLand(DoCommandFlag flags,
 			SetTileHeight(t, (uint)height);
 		}
 
+		/* Slopes of tracks, roads and shores changed; autoslope allows terraforming below them. */
+		for (TileIndexSet::const_iterator it = ts.dirty_tiles.begin(); it != ts.dirty_tiles.end(); it++) {
+			if (GetTileRailType(*it) != INVALID_RAILTYPE) YapfNotifyTrackLayoutChange(*it, INVALID_TRACK);
+			if (MayHaveRoad(*it)) YapfNotifyRoadLayoutChange(*it);
+			InvalidateWaterRegion(*it);
+		}
+
 		if (c != nullptr) c->terraform_limit -= (uint32)ts.tile_to_new_height.size() << 16;
 	}
 	return { total_cost, 0, total_cost.Succeeded() ? tile : INVALID_TILE };
@@ -0,0 +1,101 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file thread_pool.cpp Implementation of the pool of worker threads. */
+
+#include "stdafx.h"
+#include "thread.h"
+#include "thread_pool.h"
+
+#include "safeguards.h"
+
+/**
+ * Create a pool of worker threads. No threads are started yet.
+ * @param name Name of the worker threads.
+ * @param max_workers Number of workers to start, or 0 to start one per core.
+ */
+ThreadPool::ThreadPool(const char *name, uint max_workers) : name(name), max_workers(max_workers), started(false), stopping(false)
+{
+}
+
+/**
+ * Stop and join all workers. Tasks that did not start yet are discarded.
+ */
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lk(this->lock);
+		this->stopping = true;
+	}
+	this->wake.notify_all();
+
+	for (std::thread &worker : this->workers) worker.join();
+}
+
+/**
+ * Start the workers.
+ * @pre The lock is held by the caller.
+ */
+void ThreadPool::Start()
+{
+	this->started = true;
+
+	uint count = this->max_workers != 0 ? this->max_workers : std::max(1U, std::thread::hardware_concurrency());
+	for (uint i = 0; i < count; i++) {
+		std::thread worker;
+		if (!StartNewThread(&worker, this->name, &ThreadPool::Work, this)) break;
+		this->workers.push_back(std::move(worker));
+	}
+
+	Debug(misc, 3, "Started {} worker threads for '{}'", this->workers.size(), this->name);
+}
+
+/**
+ * Queue a task for execution by one of the workers.
+ * @param task The task to execute.
+ * @return Future that becomes ready once the task has been executed.
+ */
+std::future<void> ThreadPool::Submit(Task task)
+{
+	std::packaged_task<void()> packaged(std::move(task));
+	std::future<void> result = packaged.get_future();
+
+	{
+		std::lock_guard<std::mutex> lk(this->lock);
+		if (!this->started) this->Start();
+
+		if (!this->workers.empty()) {
+			this->queue.push_back(std::move(packaged));
+			this->wake.notify_one();
+			return result;
+		}
+	}
+
+	/* No threads available, so do the work right away. */
+	packaged();
+	return result;
+}
+
+/**
+ * Main loop of a worker: execute queued tasks until the pool is stopped.
+ * @param pool The pool the worker belongs to.
+ */
+/* static */ void ThreadPool::Work(ThreadPool *pool)
+{
+	for (;;) {
+		std::packaged_task<void()> task;
+		{
+			std::unique_lock<std::mutex> lk(pool->lock);
+			pool->wake.wait(lk, [pool]() { return pool->stopping || !pool->queue.empty(); });
+			if (pool->stopping) return;
+
+			task = std::move(pool->queue.front());
+			pool->queue.pop_front();
+		}
+		task();
+	}
+}
@@ -0,0 +1,51 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file thread_pool.h A fixed-size pool of worker threads. */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * A fixed-size pool of worker threads, executing tasks in the order they were submitted.
+ * The threads are only started when the first task is submitted. If no threads can be
+ * started at all, e.g. on a platform without threads, tasks are executed right away
+ * on the thread submitting them.
+ */
+class ThreadPool {
+public:
+	/** A task to execute on one of the workers. */
+	typedef std::function<void()> Task;
+
+	ThreadPool(const char *name, uint max_workers = 0);
+	~ThreadPool();
+
+	std::future<void> Submit(Task task);
+
+private:
+	const char *name;                               ///< Name of the worker threads.
+	uint max_workers;                               ///< Number of workers to start, or 0 for one per core.
+	bool started;                                   ///< Whether starting the workers has been tried.
+	bool stopping;                                  ///< Whether the workers should stop.
+	std::vector<std::thread> workers;               ///< The worker threads.
+	std::deque<std::packaged_task<void()>> queue;   ///< Tasks waiting for a worker.
+	std::mutex lock;                                ///< Lock for the state of the pool.
+	std::condition_variable wake;                   ///< Signalled when a task is queued or the workers should stop.
+
+	void Start();
+	static void Work(ThreadPool *pool);
+};
+
+#endif /* THREAD_POOL_H */
@@ -15,6 +15,10 @@
 #include "core/bitmath_func.hpp"
 #include "settings_type.h"
 
+void InvalidateWaterRegion(TileIndex tile); // pathfinder/water_regions.cpp
+void InvalidateSignalBlocks(TileIndex tile); // signal.cpp
+void InvalidateReservationIndex(); // pbs.cpp
+
 /**
  * Returns the height of a tile
  *
@@ -136,6 +140,11 @@ static inline void SetTileType(TileIndex tile, TileType type)
 	 * the upper edges of the map are also VOID tiles. */
 	assert(IsInnerTile(tile) == (type != MP_VOID));
 	SB(_m[tile].type, 4, 4, type);
+	/* Anything built on or removed from a tile passes here; it may change where ships can go,
+	 * how signal blocks are connected and where reservations lead. */
+	InvalidateWaterRegion(tile);
+	InvalidateSignalBlocks(tile);
+	InvalidateReservationIndex();
 }
 
 /**
@@ -202,6 +211,8 @@ static inline void SetTileOwner(TileIndex tile, Owner owner)
 	assert(!IsTileType(tile, MP_INDUSTRY));
 
 	SB(_m[tile].m1, 0, 5, owner);
+	InvalidateSignalBlocks(tile);
+	InvalidateReservationIndex();
 }
 
 /**
@@ -459,6 +459,7 @@ uint32 GetWorldPopulation()
 /**
  * Remove stations from nearby station list if a town is no longer in the catchment area of each.
  * To improve performance only checks stations that cover the provided house area (doesn't need to contain an actual house).
+ * These stations also have to look at the acceptance of their catchment area again.
  * @param t Town to work on
  * @param tile Location of house area (north part)
  * @param flags BuildingFlags containing the size of house area
@@ -466,13 +467,16 @@ uint32 GetWorldPopulation()
 static void RemoveNearbyStations(Town *t, TileIndex tile, BuildingFlags flags)
 {
 	for (StationList::iterator it = t->stations_near.begin(); it != t->stations_near.end(); /* incremented inside loop */) {
-		const Station *st = *it;
+		Station *st = *it;
 
 		bool covers_area = st->TileIsInCatchment(tile);
 		if (flags & BUILDING_2_TILES_Y)   covers_area |= st->TileIsInCatchment(tile + TileDiffXY(0, 1));
 		if (flags & BUILDING_2_TILES_X)   covers_area |= st->TileIsInCatchment(tile + TileDiffXY(1, 0));
 		if (flags & BUILDING_HAS_4_TILES) covers_area |= st->TileIsInCatchment(tile + TileDiffXY(1, 1));
 
+		/* The station no longer accepts what the house accepted. */
+		if (covers_area) st->catchment_acceptance_valid = false;
+
 		if (covers_area && !st->CatchmentCoversTown(t->index)) {
 			it = t->stations_near.erase(it);
 		} else {
@@ -2337,6 +2341,7 @@ static void MakeTownHouse(TileIndex t, Town *town, byte counter, byte stage, Hou
 
 	ForAllStationsAroundTiles(TileArea(t, (size & BUILDING_2_TILES_X) ? 2 : 1, (size & BUILDING_2_TILES_Y) ? 2 : 1), [town](Station *st, TileIndex tile) {
 		town->stations_near.insert(st);
+		st->catchment_acceptance_valid = false;
 		return true;
 	});
 }
@@ -3257,6 +3262,7 @@ static CommandCost TownActionBribe(Town *t, DoCommandFlag flags)
 			for (Station *st : Station::Iterate()) {
 				if (st->town == t && st->owner == _current_company) {
 					for (CargoID i = 0; i < NUM_CARGO; i++) st->goods[i].rating = 0;
+					st->rating_cargoes = ALL_CARGOTYPES;
 				}
 			}
 
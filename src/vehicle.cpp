@@ -51,6 +51,10 @@
 #include "linkgraph/linkgraph.h"
 #include "linkgraph/refresh.h"
 #include "framerate_type.h"
+#include "console_func.h"
+#include "thread_pool.h"
+#include "pathfinder/water_regions.h"
+#include "pathfinder/yapf/yapf.h"
 #include "autoreplace_cmd.h"
 #include "misc_cmd.h"
 #include "train_cmd.h"
@@ -90,6 +94,7 @@ static const uint GEN_HASHY_MASK = ((1 << GEN_HASHY_BITS) - 1) << GEN_HASHX_BITS
 VehiclePool _vehicle_pool("Vehicle");
 INSTANTIATE_POOL_METHODS(Vehicle)
 
+VehicleIndexSet _vehicles_by_type[VEH_END]; ///< Indices of the vehicles in the pool, per vehicle type.
 
 /**
  * Determine shared bounds of all sprites.
@@ -354,6 +359,8 @@ Vehicle::Vehicle(VehicleType type)
 	this->cargo_age_counter  = 1;
 	this->last_station_visited = INVALID_STATION;
 	this->last_loading_station = INVALID_STATION;
+	this->tile_grid_cell     = INVALID_VEHICLE_GRID_CELL;
+	if (type < VEH_END) _vehicles_by_type[type].Include(this->index);
 }
 
 /**
@@ -365,32 +372,126 @@ byte VehicleRandomBits()
 	return GB(Random(), 0, 8);
 }
 
-/* Size of the hash, 6 = 64 x 64, 7 = 128 x 128. Larger sizes will (in theory) reduce hash
- * lookup times at the expense of memory usage. */
-const int HASH_BITS = 7;
-const int HASH_SIZE = 1 << HASH_BITS;
-const int HASH_MASK = HASH_SIZE - 1;
-const int TOTAL_HASH_SIZE = 1 << (HASH_BITS * 2);
-const int TOTAL_HASH_MASK = TOTAL_HASH_SIZE - 1;
+/*
+ * Grid with the vehicles on the map, indexed by the tile they are on. Every
+ * cell covers a square of tiles and holds its vehicles in a contiguous vector.
+ * On small maps a cell is one tile; on larger maps cells cover more tiles so
+ * the number of cells, and with that the memory usage, stays bounded.
+ */
+static const uint VEHICLE_GRID_MAX_BITS = 20; ///< At most 1 << VEHICLE_GRID_MAX_BITS cells in the grid.
 
-/* Resolution of the hash, 0 = 1*1 tile, 1 = 2*2 tiles, 2 = 4*4 tiles, etc.
- * Profiling results show that 0 is fastest. */
-const int HASH_RES = 0;
+static std::vector<std::vector<Vehicle *>> _vehicle_tile_grid; ///< Vehicles per grid cell.
+static uint _vehicle_tile_grid_shift;  ///< Cells cover squares of 1 << _vehicle_tile_grid_shift tiles.
+static uint _vehicle_tile_grid_log_x;  ///< Logarithm of the number of cells in the X direction.
+static uint _vehicle_tile_grid_max_y;  ///< Highest cell coordinate in the Y direction.
+static uint _vehicle_tile_grid_map_size; ///< Size of the map the grid was made for.
 
-static Vehicle *_vehicle_tile_hash[TOTAL_HASH_SIZE];
+static std::atomic<uint64> _vehicle_tile_grid_lookups; ///< Number of grid cells looked at by the vehicle searches.
+static std::atomic<uint64> _vehicle_tile_grid_visits;  ///< Number of vehicles visited in the looked at grid cells.
 
-static Vehicle *VehicleFromTileHash(int xl, int yl, int xu, int yu, void *data, VehicleFromPosProc *proc, bool find_first)
+/**
+ * Get the index of the grid cell with the given cell coordinates.
+ * @param x The X coordinate of the cell.
+ * @param y The Y coordinate of the cell.
+ * @return The index in #_vehicle_tile_grid.
+ */
+static inline uint GetVehicleGridCell(uint x, uint y)
 {
-	for (int y = yl; ; y = (y + (1 << HASH_BITS)) & (HASH_MASK << HASH_BITS)) {
-		for (int x = xl; ; x = (x + 1) & HASH_MASK) {
-			Vehicle *v = _vehicle_tile_hash[(x + y) & TOTAL_HASH_MASK];
-			for (; v != nullptr; v = v->hash_tile_next) {
-				Vehicle *a = proc(v, data);
-				if (find_first && a != nullptr) return a;
-			}
-			if (x == xu) break;
+	return (y << _vehicle_tile_grid_log_x) + x;
+}
+
+/**
+ * Get the index of the grid cell the given tile is in.
+ * @param tile The tile.
+ * @return The index in #_vehicle_tile_grid.
+ */
+static inline uint GetVehicleGridCell(TileIndex tile)
+{
+	return GetVehicleGridCell(TileX(tile) >> _vehicle_tile_grid_shift, std::min(TileY(tile) >> _vehicle_tile_grid_shift, _vehicle_tile_grid_max_y));
+}
+
+/**
+ * Clear the vehicle grid and size it for the current map.
+ * All vehicles have to be added again.
+ */
+static void ResetVehicleTileGrid()
+{
+	uint log_x = MapLogX();
+	uint log_y = MapLogY();
+	uint shift = 0;
+	while (log_x + log_y - 2 * shift > VEHICLE_GRID_MAX_BITS) shift++;
+
+	_vehicle_tile_grid_shift = shift;
+	_vehicle_tile_grid_log_x = log_x - shift;
+	_vehicle_tile_grid_max_y = (1 << (log_y - shift)) - 1;
+	_vehicle_tile_grid_map_size = MapSize();
+
+	_vehicle_tile_grid.clear();
+	_vehicle_tile_grid.resize((size_t)1 << (log_x + log_y - 2 * shift));
+
+	for (Vehicle *v : Vehicle::Iterate()) v->tile_grid_cell = INVALID_VEHICLE_GRID_CELL;
+}
+
+/**
+ * Make sure the vehicle grid matches the map; the map might have been
+ * reallocated, e.g. while loading a savegame.
+ */
+static inline void ValidateVehicleTileGrid()
+{
+	if (_vehicle_tile_grid_map_size != MapSize()) ResetVehicleTileGrid();
+}
+
+/**
+ * Call \a proc for the vehicles in one cell of the grid.
+ * @param cell The index of the cell.
+ * @param tile Only vehicles on this tile, or any vehicle in the cell when #INVALID_TILE.
+ * @param data Arbitrary data passed to \a proc.
+ * @param proc The proc that determines whether a vehicle will be "found".
+ * @param find_first Whether to return on the first found or iterate over all vehicles.
+ * @return The first vehicle \a proc returned, when \a find_first is set.
+ */
+static Vehicle *VehicleFromGridCell(uint cell, TileIndex tile, void *data, VehicleFromPosProc *proc, bool find_first)
+{
+	const std::vector<Vehicle *> &vehicles = _vehicle_tile_grid[cell];
+	_vehicle_tile_grid_lookups.fetch_add(1, std::memory_order_relaxed);
+	_vehicle_tile_grid_visits.fetch_add(vehicles.size(), std::memory_order_relaxed);
+
+	/* The proc can create vehicles (e.g. effects), which may end up in this
+	 * cell and reallocate it, so iterate by index. When the proc removes the
+	 * current vehicle from the cell, another vehicle takes its slot; process
+	 * that slot again instead of going forward.
+	 * NOTE: removing another vehicle from the cell during the search may make
+	 *       us miss a vehicle, but no proc seems to be doing this anyway. */
+	for (size_t i = 0; i < vehicles.size(); /* nothing */) {
+		Vehicle *v = vehicles[i];
+		if (tile == INVALID_TILE || v->tile == tile) {
+			Vehicle *a = proc(v, data);
+			if (find_first && a != nullptr) return a;
+		}
+		if (i < vehicles.size() && vehicles[i] == v) i++;
+	}
+
+	return nullptr;
+}
+
+/**
+ * Call \a proc for the vehicles in a rectangle of cells of the grid.
+ * @param xl The lowest X coordinate of the cells.
+ * @param yl The lowest Y coordinate of the cells.
+ * @param xu The highest X coordinate of the cells.
+ * @param yu The highest Y coordinate of the cells.
+ * @param data Arbitrary data passed to \a proc.
+ * @param proc The proc that determines whether a vehicle will be "found".
+ * @param find_first Whether to return on the first found or iterate over all vehicles.
+ * @return The first vehicle \a proc returned, when \a find_first is set.
+ */
+static Vehicle *VehicleFromTileGrid(uint xl, uint yl, uint xu, uint yu, void *data, VehicleFromPosProc *proc, bool find_first)
+{
+	for (uint y = yl; y <= yu; y++) {
+		for (uint x = xl; x <= xu; x++) {
+			Vehicle *a = VehicleFromGridCell(GetVehicleGridCell(x, y), INVALID_TILE, data, proc, find_first);
+			if (find_first && a != nullptr) return a;
 		}
-		if (y == yu) break;
 	}
 
 	return nullptr;
@@ -412,13 +513,15 @@ static Vehicle *VehicleFromPosXY(int x, int y, void *data, VehicleFromPosProc *p
 {
 	const int COLL_DIST = 6;
 
-	/* Hash area to scan is from xl,yl to xu,yu */
-	int xl = GB((x - COLL_DIST) / TILE_SIZE, HASH_RES, HASH_BITS);
-	int xu = GB((x + COLL_DIST) / TILE_SIZE, HASH_RES, HASH_BITS);
-	int yl = GB((y - COLL_DIST) / TILE_SIZE, HASH_RES, HASH_BITS) << HASH_BITS;
-	int yu = GB((y + COLL_DIST) / TILE_SIZE, HASH_RES, HASH_BITS) << HASH_BITS;
+	ValidateVehicleTileGrid();
 
-	return VehicleFromTileHash(xl, yl, xu, yu, data, proc, find_first);
+	/* Grid area to scan is from xl,yl to xu,yu */
+	uint xl = Clamp((x - COLL_DIST) / (int)TILE_SIZE, 0, (int)MapMaxX()) >> _vehicle_tile_grid_shift;
+	uint xu = Clamp((x + COLL_DIST) / (int)TILE_SIZE, 0, (int)MapMaxX()) >> _vehicle_tile_grid_shift;
+	uint yl = Clamp((y - COLL_DIST) / (int)TILE_SIZE, 0, (int)MapMaxY()) >> _vehicle_tile_grid_shift;
+	uint yu = Clamp((y + COLL_DIST) / (int)TILE_SIZE, 0, (int)MapMaxY()) >> _vehicle_tile_grid_shift;
+
+	return VehicleFromTileGrid(xl, yl, xu, yu, data, proc, find_first);
 }
 
 /**
@@ -468,18 +571,9 @@ bool HasVehicleOnPosXY(int x, int y, void *data, VehicleFromPosProc *proc)
  */
 static Vehicle *VehicleFromPos(TileIndex tile, void *data, VehicleFromPosProc *proc, bool find_first)
 {
-	int x = GB(TileX(tile), HASH_RES, HASH_BITS);
-	int y = GB(TileY(tile), HASH_RES, HASH_BITS) << HASH_BITS;
-
-	Vehicle *v = _vehicle_tile_hash[(x + y) & TOTAL_HASH_MASK];
-	for (; v != nullptr; v = v->hash_tile_next) {
-		if (v->tile != tile) continue;
-
-		Vehicle *a = proc(v, data);
-		if (find_first && a != nullptr) return a;
-	}
+	ValidateVehicleTileGrid();
 
-	return nullptr;
+	return VehicleFromGridCell(GetVehicleGridCell(tile), tile, data, proc, find_first);
 }
 
 /**
@@ -515,6 +609,39 @@ bool HasVehicleOnPos(TileIndex tile, void *data, VehicleFromPosProc *proc)
 	return VehicleFromPos(tile, data, proc, true) != nullptr;
 }
 
+/**
+ * Get all vehicles on the tiles of an area.
+ * @param ta The area to look at.
+ * @param[out] vehicles The vehicles in the area, sorted by their index.
+ */
+void GetVehiclesInTileArea(const TileArea &ta, std::vector<Vehicle *> &vehicles)
+{
+	vehicles.clear();
+	if (ta.tile == INVALID_TILE || ta.w == 0 || ta.h == 0) return;
+
+	ValidateVehicleTileGrid();
+
+	uint xl = TileX(ta.tile) >> _vehicle_tile_grid_shift;
+	uint yl = TileY(ta.tile) >> _vehicle_tile_grid_shift;
+	uint xu = (TileX(ta.tile) + ta.w - 1) >> _vehicle_tile_grid_shift;
+	uint yu = (TileY(ta.tile) + ta.h - 1) >> _vehicle_tile_grid_shift;
+
+	for (uint y = yl; y <= yu; y++) {
+		for (uint x = xl; x <= xu; x++) {
+			const std::vector<Vehicle *> &cell = _vehicle_tile_grid[GetVehicleGridCell(x, y)];
+			_vehicle_tile_grid_lookups.fetch_add(1, std::memory_order_relaxed);
+			_vehicle_tile_grid_visits.fetch_add(cell.size(), std::memory_order_relaxed);
+
+			for (Vehicle *v : cell) {
+				if (ta.Contains(v->tile)) vehicles.push_back(v);
+			}
+		}
+	}
+
+	/* The order within the cells depends on the history of the game; make it deterministic. */
+	std::sort(vehicles.begin(), vehicles.end(), [](const Vehicle *a, const Vehicle *b) { return a->index < b->index; });
+}
+
 /**
  * Callback that returns 'real' vehicles lower or at height \c *(int*)data .
  * @param v Vehicle to examine.
@@ -609,37 +736,60 @@ CommandCost EnsureNoTrainOnTrackBits(TileIndex tile, TrackBits track_bits)
 	return CommandCost();
 }
 
-static void UpdateVehicleTileHash(Vehicle *v, bool remove)
+static void UpdateVehicleTileGrid(Vehicle *v, bool remove)
 {
-	Vehicle **old_hash = v->hash_tile_current;
-	Vehicle **new_hash;
+	ValidateVehicleTileGrid();
 
-	if (remove) {
-		new_hash = nullptr;
-	} else {
-		int x = GB(TileX(v->tile), HASH_RES, HASH_BITS);
-		int y = GB(TileY(v->tile), HASH_RES, HASH_BITS) << HASH_BITS;
-		new_hash = &_vehicle_tile_hash[(x + y) & TOTAL_HASH_MASK];
-	}
+	uint32 old_cell = v->tile_grid_cell;
+	uint32 new_cell = remove ? INVALID_VEHICLE_GRID_CELL : GetVehicleGridCell(v->tile);
 
-	if (old_hash == new_hash) return;
+	if (old_cell == new_cell) return;
 
-	/* Remove from the old position in the hash table */
-	if (old_hash != nullptr) {
-		if (v->hash_tile_next != nullptr) v->hash_tile_next->hash_tile_prev = v->hash_tile_prev;
-		*v->hash_tile_prev = v->hash_tile_next;
+	/* Remove from the old cell; the last vehicle of that cell takes over its slot. */
+	if (old_cell != INVALID_VEHICLE_GRID_CELL) {
+		std::vector<Vehicle *> &cell = _vehicle_tile_grid[old_cell];
+		Vehicle *last = cell.back();
+		cell[v->tile_grid_slot] = last;
+		last->tile_grid_slot = v->tile_grid_slot;
+		cell.pop_back();
 	}
 
-	/* Insert vehicle at beginning of the new position in the hash table */
-	if (new_hash != nullptr) {
-		v->hash_tile_next = *new_hash;
-		if (v->hash_tile_next != nullptr) v->hash_tile_next->hash_tile_prev = &v->hash_tile_next;
-		v->hash_tile_prev = new_hash;
-		*new_hash = v;
+	/* Add to the end of the new cell */
+	if (new_cell != INVALID_VEHICLE_GRID_CELL) {
+		std::vector<Vehicle *> &cell = _vehicle_tile_grid[new_cell];
+		v->tile_grid_slot = (uint32)cell.size();
+		cell.push_back(v);
 	}
 
-	/* Remember current hash position */
-	v->hash_tile_current = new_hash;
+	v->tile_grid_cell = new_cell;
+}
+
+/**
+ * Print the statistics of the vehicle tile grid to the console.
+ * @param reset Whether to reset the search counters afterwards.
+ */
+void ConPrintVehicleGridStatistics(bool reset)
+{
+	size_t vehicles = 0;
+	size_t occupied = 0;
+	size_t longest = 0;
+	for (const auto &cell : _vehicle_tile_grid) {
+		if (cell.empty()) continue;
+		vehicles += cell.size();
+		occupied++;
+		longest = std::max(longest, cell.size());
+	}
+
+	IConsolePrint(CC_INFO, "Vehicle grid: {} cells of {}x{} tiles.", _vehicle_tile_grid.size(), 1 << _vehicle_tile_grid_shift, 1 << _vehicle_tile_grid_shift);
+	IConsolePrint(CC_INFO, "  {} vehicles in {} occupied cells; average chain length {:.2f}, longest {}.",
+			vehicles, occupied, occupied == 0 ? 0.0 : (double)vehicles / occupied, longest);
+	IConsolePrint(CC_INFO, "  {} cells searched, {:.2f} vehicles visited per searched cell.",
+			_vehicle_tile_grid_lookups.load(), _vehicle_tile_grid_lookups == 0 ? 0.0 : (double)_vehicle_tile_grid_visits / _vehicle_tile_grid_lookups);
+
+	if (reset) {
+		_vehicle_tile_grid_lookups = 0;
+		_vehicle_tile_grid_visits = 0;
+	}
 }
 
 static Vehicle *_vehicle_viewport_hash[1 << (GEN_HASHX_BITS + GEN_HASHY_BITS)];
@@ -670,9 +820,8 @@ static void UpdateVehicleViewportHash(Vehicle *v, int x, int y, int old_x, int o
 
 void ResetVehicleHash()
 {
-	for (Vehicle *v : Vehicle::Iterate()) { v->hash_tile_current = nullptr; }
 	memset(_vehicle_viewport_hash, 0, sizeof(_vehicle_viewport_hash));
-	memset(_vehicle_tile_hash, 0, sizeof(_vehicle_tile_hash));
+	ResetVehicleTileGrid();
 }
 
 void ResetVehicleColourMap()
@@ -879,6 +1028,8 @@ void Vehicle::PreDestructor()
 
 Vehicle::~Vehicle()
 {
+	if (this->type < VEH_END) _vehicles_by_type[this->type].Exclude(this->index);
+
 	if (CleaningPool()) {
 		this->cargo.OnCleanPool();
 		return;
@@ -893,7 +1044,7 @@ Vehicle::~Vehicle()
 
 	delete v;
 
-	UpdateVehicleTileHash(this, true);
+	UpdateVehicleTileGrid(this, true);
 	UpdateVehicleViewportHash(this, INVALID_COORD, 0, this->sprite_cache.old_coord.left, this->sprite_cache.old_coord.top);
 	DeleteVehicleNews(this->index, INVALID_STRING_ID);
 	DeleteNewGRFInspectWindow(GetGrfSpecFeature(this->type), this->index);
@@ -951,6 +1102,58 @@ static void RunVehicleDayProc()
 	}
 }
 
+uint8 _vehicle_plan_threads; ///< Number of worker threads planning the vehicle ticks ahead; 0 to not plan ahead.
+uint32 _vehicle_plan_round;  ///< Number of the current round of vehicle ticks; plans made for another round are stale.
+
+/**
+ * Let vehicles plan, on worker threads, decisions they might have to take
+ * during their tick and that only read the game state, e.g. choosing a path.
+ * The vehicle ticks themselves stay serial and in order. A vehicle only uses
+ * its plan when everything it depended on is still the same at the moment of
+ * the decision, so the outcome is identical to not planning ahead at all.
+ */
+static void PlanVehicleTicks()
+{
+	static std::unique_ptr<ThreadPool> workers;
+	static std::vector<Vehicle *> vehicles;
+
+	if (workers == nullptr) workers.reset(new ThreadPool("ottd:vehplan", _vehicle_plan_threads));
+
+	vehicles.clear();
+	for (Vehicle *v : Vehicle::Iterate()) {
+		switch (v->type) {
+			case VEH_SHIP: if (CanPlanShipTrack(Ship::From(v))) vehicles.push_back(v); break;
+			case VEH_ROAD: if (CanPlanRoadVehPath(RoadVehicle::From(v))) vehicles.push_back(v); break;
+			default: break;
+		}
+	}
+	if (vehicles.empty()) return;
+
+	/* The planning threads only look at water regions and the pathfinder caches, they must not update them. */
+	if (_settings_game.pf.yapf.ship_water_regions) UpdateWaterRegions();
+	YapfRoadUpdateCaches();
+
+	/* A few chunks per worker, to even out searches of different lengths. */
+	const size_t chunks = std::min<size_t>(vehicles.size(), _vehicle_plan_threads * 4);
+	const uint32 round = _vehicle_plan_round;
+	std::vector<std::future<void>> tasks;
+	for (size_t i = 0; i < chunks; i++) {
+		size_t begin = vehicles.size() * i / chunks;
+		size_t end = vehicles.size() * (i + 1) / chunks;
+		tasks.push_back(workers->Submit([begin, end, round]() {
+			for (size_t j = begin; j < end; j++) {
+				Vehicle *v = vehicles[j];
+				if (v->type == VEH_SHIP) {
+					PlanShipTrack(Ship::From(v), round);
+				} else {
+					PlanRoadVehPath(RoadVehicle::From(v), round);
+				}
+			}
+		}));
+	}
+	for (auto &task : tasks) task.wait();
+}
+
 void CallVehicleTicks()
 {
 	_vehicles_to_autoreplace.clear();
@@ -961,11 +1164,16 @@ void CallVehicleTicks()
 		PerformanceMeasurer framerate(PFE_GL_ECONOMY);
 		for (Station *st : Station::Iterate()) LoadUnloadStation(st);
 	}
+
 	PerformanceAccumulator::Reset(PFE_GL_TRAINS);
 	PerformanceAccumulator::Reset(PFE_GL_ROADVEHS);
 	PerformanceAccumulator::Reset(PFE_GL_SHIPS);
 	PerformanceAccumulator::Reset(PFE_GL_AIRCRAFT);
 
+	_vehicle_plan_round++;
+	/* Planning is shared by all vehicle types, so it only counts towards the whole game loop. */
+	if (_vehicle_plan_threads != 0) PlanVehicleTicks();
+
 	for (Vehicle *v : Vehicle::Iterate()) {
 		[[maybe_unused]] size_t vehicle_index = v->index;
 
@@ -1609,7 +1817,7 @@ void VehicleEnterDepot(Vehicle *v)
  */
 void Vehicle::UpdatePosition()
 {
-	UpdateVehicleTileHash(this, false);
+	UpdateVehicleTileGrid(this, false);
 }
 
 /**
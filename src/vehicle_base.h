@@ -11,6 +11,7 @@
 #define VEHICLE_BASE_H
 
 #include "core/smallmap_type.hpp"
+#include "core/bitmath_func.hpp"
 #include "track_type.h"
 #include "command_type.h"
 #include "order_base.h"
@@ -29,6 +30,8 @@
 const uint TILE_AXIAL_DISTANCE = 192;  // Logical length of the tile in any DiagDirection used in vehicle movement.
 const uint TILE_CORNER_DISTANCE = 128;  // Logical length of the tile corner crossing in any non-diagonal direction used in vehicle movement.
 
+static const uint32 INVALID_VEHICLE_GRID_CELL = UINT32_MAX; ///< Vehicle is not in the vehicle tile grid.
+
 /** Vehicle status bits in #Vehicle::vehstatus. */
 enum VehStatus {
 	VS_HIDDEN          = 0x01, ///< Vehicle is not visible.
@@ -201,6 +204,57 @@ struct MutableSpriteCache {
 typedef Pool<Vehicle, VehicleID, 512, 0xFF000> VehiclePool;
 extern VehiclePool _vehicle_pool;
 
+/**
+ * Set of vehicle pool indices, stored as a bitmap. Iterating over the set
+ * visits the indices in ascending order and skips empty stretches of the
+ * pool a whole word at a time.
+ */
+class VehicleIndexSet {
+	std::vector<uint64> bits; ///< One bit per pool index.
+
+public:
+	/**
+	 * Add an index to the set.
+	 * @param index The index to add.
+	 */
+	inline void Include(size_t index)
+	{
+		size_t word = index / 64;
+		if (word >= this->bits.size()) this->bits.resize(word + 1, 0);
+		SetBit(this->bits[word], index % 64);
+	}
+
+	/**
+	 * Remove an index from the set.
+	 * @param index The index to remove.
+	 */
+	inline void Exclude(size_t index)
+	{
+		size_t word = index / 64;
+		if (word < this->bits.size()) ClrBit(this->bits[word], index % 64);
+	}
+
+	/**
+	 * Find the first index in the set that is not lower than the given index.
+	 * @param index The index to start searching at.
+	 * @return The found index, or VehiclePool::MAX_SIZE when there is none.
+	 */
+	inline size_t Next(size_t index) const
+	{
+		size_t word = index / 64;
+		if (word >= this->bits.size()) return VehiclePool::MAX_SIZE;
+		uint64 mask = this->bits[word] & (UINT64_MAX << (index % 64));
+		while (mask == 0) {
+			if (++word >= this->bits.size()) return VehiclePool::MAX_SIZE;
+			mask = this->bits[word];
+		}
+		return word * 64 + FindFirstBit(mask);
+	}
+};
+
+/** Indices of the vehicles in the pool, per vehicle type. */
+extern VehicleIndexSet _vehicles_by_type[VEH_END];
+
 /* Some declarations of functions, so we can make them friendly */
 struct GroundVehicleCache;
 struct LoadgameState;
@@ -262,9 +316,8 @@ public:
 	Vehicle *hash_viewport_next;        ///< NOSAVE: Next vehicle in the visual location hash.
 	Vehicle **hash_viewport_prev;       ///< NOSAVE: Previous vehicle in the visual location hash.
 
-	Vehicle *hash_tile_next;            ///< NOSAVE: Next vehicle in the tile location hash.
-	Vehicle **hash_tile_prev;           ///< NOSAVE: Previous vehicle in the tile location hash.
-	Vehicle **hash_tile_current;        ///< NOSAVE: Cache of the current hash chain.
+	uint32 tile_grid_cell;              ///< NOSAVE: Cell of the vehicle tile grid the vehicle is in.
+	uint32 tile_grid_slot;              ///< NOSAVE: Position of the vehicle within its cell of the vehicle tile grid.
 
 	SpriteID colourmap;                 ///< NOSAVE: cached colour mapping
 
@@ -1244,12 +1297,43 @@ struct SpecializedVehicle : public Vehicle {
 		}
 	}
 
+	/**
+	 * Iterator over the valid vehicles of type T. Only the indices in
+	 * #_vehicles_by_type are visited instead of the whole pool.
+	 */
+	struct TypeIterator {
+		typedef T value_type;
+		typedef T* pointer;
+		typedef T& reference;
+		typedef size_t difference_type;
+		typedef std::forward_iterator_tag iterator_category;
+
+		explicit TypeIterator(size_t index) : index(_vehicles_by_type[Type].Next(index)) {}
+
+		bool operator==(const TypeIterator &other) const { return this->index == other.index; }
+		bool operator!=(const TypeIterator &other) const { return !(*this == other); }
+		T * operator*() const { return T::Get(this->index); }
+		TypeIterator & operator++() { this->index = _vehicles_by_type[Type].Next(this->index + 1); return *this; }
+
+	private:
+		size_t index;
+	};
+
+	/** Iterable ensemble of all valid vehicles of type T. */
+	struct IterateWrapper {
+		size_t from;
+		IterateWrapper(size_t from = 0) : from(from) {}
+		TypeIterator begin() { return TypeIterator(this->from); }
+		TypeIterator end() { return TypeIterator(Pool::MAX_SIZE); }
+		bool empty() { return this->begin() == this->end(); }
+	};
+
 	/**
 	 * Returns an iterable ensemble of all valid vehicles of type T
 	 * @param from index of the first vehicle to consider
 	 * @return an iterable ensemble of all valid vehicles of type T
 	 */
-	static Pool::IterateWrapper<T> Iterate(size_t from = 0) { return Pool::IterateWrapper<T>(from); }
+	static IterateWrapper Iterate(size_t from = 0) { return IterateWrapper(from); }
 };
 
 /** Generates sequence of free UnitID numbers */
@@ -19,6 +19,10 @@
 #include "newgrf_config.h"
 #include "track_type.h"
 #include "livery.h"
+#include "tilearea_type.h"
+
+extern uint8 _vehicle_plan_threads;
+extern uint32 _vehicle_plan_round;
 
 #define is_custom_sprite(x) (x >= 0xFD)
 #define IS_CUSTOM_FIRSTHEAD_SPRITE(x) (x == 0xFD)
@@ -44,6 +48,7 @@ void FindVehicleOnPos(TileIndex tile, void *data, VehicleFromPosProc *proc);
 void FindVehicleOnPosXY(int x, int y, void *data, VehicleFromPosProc *proc);
 bool HasVehicleOnPos(TileIndex tile, void *data, VehicleFromPosProc *proc);
 bool HasVehicleOnPosXY(int x, int y, void *data, VehicleFromPosProc *proc);
+void GetVehiclesInTileArea(const TileArea &ta, std::vector<Vehicle *> &vehicles);
 void CallVehicleTicks();
 uint8 CalcPercentVehicleFilled(const Vehicle *v, StringID *colour);
 
@@ -12,8 +12,13 @@
 #include "../blitter/factory.hpp"
 #include "../saveload/saveload.h"
 #include "../window_func.h"
+#include "../framerate_type.h"
+#include "../fileio_func.h"
+#include "../openttd.h"
 #include "null_v.h"
 
+#include <chrono>
+
 #include "../safeguards.h"
 
 /** Factory for the null video driver. */
@@ -29,6 +34,11 @@ const char *VideoDriver_Null::Start(const StringList &parm)
 	this->UpdateAutoResolution();
 
 	this->ticks = GetDriverParamInt(parm, "ticks", 1000);
+	const char *benchmark = GetDriverParam(parm, "benchmark");
+	this->benchmark = benchmark != nullptr;
+	this->report = this->benchmark ? benchmark : "";
+	/* A benchmark needs at least one tick to report statistics about. */
+	if (this->benchmark) this->ticks = std::max(this->ticks, 1U);
 	_screen.width  = _screen.pitch = _cur_resolution.width;
 	_screen.height = _cur_resolution.height;
 	_screen.dst_ptr = nullptr;
@@ -44,8 +54,119 @@ void VideoDriver_Null::Stop() { }
 
 void VideoDriver_Null::MakeDirty(int left, int top, int width, int height) {}
 
+/** Identifiers of the performance elements in the benchmark report, in #PerformanceElement order. */
+static const char * const BENCHMARK_ELEMENT_NAMES[] = {
+	"gameloop",
+	"gl_economy",
+	"gl_trains",
+	"gl_roadvehs",
+	"gl_ships",
+	"gl_aircraft",
+	"gl_landscape",
+	"gl_linkgraph",
+	"drawing",
+	"drawworld",
+	"video",
+	"sound",
+	"allscripts",
+	"gamescript",
+};
+static_assert(lengthof(BENCHMARK_ELEMENT_NAMES) == PFE_AI0);
+
+/**
+ * Get a percentile of a set of measurements using the nearest-rank method.
+ * @param sorted Measurements, sorted in ascending order; must not be empty.
+ * @param percent The percentile to get.
+ * @return The measurement at the given percentile.
+ */
+static TimingMeasurement GetPercentile(const std::vector<TimingMeasurement> &sorted, uint percent)
+{
+	size_t rank = (sorted.size() * percent + 99) / 100;
+	return sorted[std::max<size_t>(rank, 1) - 1];
+}
+
+/**
+ * Format the statistics of a set of measurements as a JSON object.
+ * @param measurements Measurements in microseconds, will be sorted.
+ * @return The JSON object.
+ */
+static std::string FormatBenchmarkStatistics(std::vector<TimingMeasurement> &measurements)
+{
+	std::sort(measurements.begin(), measurements.end());
+	TimingMeasurement total = 0;
+	for (TimingMeasurement m : measurements) total += m;
+
+	return fmt::format("{{\"total_us\": {}, \"mean_us\": {:.2f}, \"min_us\": {}, \"median_us\": {}, \"p99_us\": {}, \"max_us\": {}}}",
+			total, (double)total / measurements.size(), measurements.front(), GetPercentile(measurements, 50), GetPercentile(measurements, 99), measurements.back());
+}
+
+/**
+ * Run the loaded game for the requested number of ticks, timing every tick
+ * as a whole and per #PerformanceElement, and write a JSON report of it.
+ */
+void VideoDriver_Null::RunBenchmark()
+{
+	/* The first iteration loads the requested game; that is not part of the measurements. */
+	::GameLoop();
+	if (_game_mode != GM_NORMAL) {
+		Debug(misc, 0, "Benchmark aborted, no game was loaded");
+		return;
+	}
+	/* The game might have been saved while paused, but we want to measure it running. */
+	_pause_mode = PM_UNPAUSED;
+
+	TimingMeasurement totals[PFE_MAX];
+	CollectPerformanceTotals(totals);
+
+	std::vector<TimingMeasurement> tick_times;
+	std::vector<TimingMeasurement> element_times[PFE_MAX];
+	tick_times.reserve(this->ticks);
+	for (auto &times : element_times) times.reserve(this->ticks);
+
+	using namespace std::chrono;
+	auto run_start = steady_clock::now();
+	for (uint i = 0; i < this->ticks; i++) {
+		auto tick_start = steady_clock::now();
+		::GameLoop();
+		::InputLoop();
+		::UpdateWindows();
+		tick_times.push_back(duration_cast<microseconds>(steady_clock::now() - tick_start).count());
+
+		CollectPerformanceTotals(totals);
+		for (PerformanceElement e = PFE_FIRST; e < PFE_MAX; e++) element_times[e].push_back(totals[e]);
+	}
+	auto run_time = duration_cast<microseconds>(steady_clock::now() - run_start).count();
+
+	std::string json = fmt::format("{{\n\t\"ticks\": {},\n\t\"wall_time_us\": {},\n\t\"ticks_per_second\": {:.2f},\n\t\"tick\": {},\n\t\"elements\": {{\n",
+			this->ticks, run_time, run_time > 0 ? this->ticks * 1000000.0 / run_time : 0.0, FormatBenchmarkStatistics(tick_times));
+	for (PerformanceElement e = PFE_FIRST; e < PFE_MAX; e++) {
+		std::string name = e < PFE_AI0 ? BENCHMARK_ELEMENT_NAMES[e] : fmt::format("ai{}", e - PFE_AI0);
+		json += fmt::format("\t\t\"{}\": {}{}\n", name, FormatBenchmarkStatistics(element_times[e]), e + 1 < PFE_MAX ? "," : "");
+	}
+	json += "\t}\n}\n";
+
+	if (this->report.empty()) {
+		fputs(json.c_str(), stdout);
+		fflush(stdout);
+		return;
+	}
+
+	FILE *f = FioFOpenFile(this->report, "wt", Subdirectory::NO_DIRECTORY);
+	if (f == nullptr) {
+		Debug(misc, 0, "Cannot write benchmark report to '{}'", this->report);
+		return;
+	}
+	FileCloser fcloser(f);
+	fputs(json.c_str(), f);
+}
+
 void VideoDriver_Null::MainLoop()
 {
+	if (this->benchmark) {
+		this->RunBenchmark();
+		return;
+	}
+
 	uint i;
 
 	for (i = 0; i < this->ticks; i++) {
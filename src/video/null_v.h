@@ -15,7 +15,11 @@
 /** The null video driver. */
 class VideoDriver_Null : public VideoDriver {
 private:
-	uint ticks; ///< Amount of ticks to run.
+	uint ticks;            ///< Amount of ticks to run.
+	bool benchmark;        ///< Whether to time the ticks and report the results.
+	std::string report;    ///< File to write the benchmark report to, or empty for stdout.
+
+	void RunBenchmark();
 
 public:
 	const char *Start(const StringList &param) override;
@@ -1347,6 +1347,7 @@ static void ChangeTileOwner_Water(TileIndex tile, Owner old_owner, Owner new_own
 		if (IsShipDepot(tile)) {
 			Company::Get(old_owner)->infrastructure.water -= LOCK_DEPOT_TILE_FACTOR;
 			Company::Get(new_owner)->infrastructure.water += LOCK_DEPOT_TILE_FACTOR;
+			Depot::generation++;
 		}
 
 		SetTileOwner(tile, new_owner);